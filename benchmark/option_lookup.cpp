@@ -0,0 +1,117 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This benchmark file calibrates `optrone::linear_lookup_limit` on the
+/// machine: it times parsing long options against scopes of increasing size,
+/// with the long names scanned linearly and hashed, and reports the largest
+/// scope size for which the linear scan is still faster.
+///
+/// Usage: `option_lookup [arguments count]`
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <format>
+#include <limits>
+#include <memory>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "optrone/parser.hpp"
+#include "optrone/template.hpp"
+
+/// Number of times each parse is run, the fastest run is reported.
+constexpr std::size_t runs_count = 31;
+
+/// Hashing must be faster by this factor to win, the linear scan is preferred
+/// on a tie (as it has nothing to build).
+constexpr double hashing_margin = 0.95;
+
+/// Get a made-up option name, of varied length and with common prefixes as in
+/// real command-line interfaces (e.g. `output-format-01f`). The names have
+/// distinct lookup keys, so that the linear scan is not ruled out.
+std::string get_option_name(std::size_t index)
+{
+    static const std::vector<std::string> words = { "output", "verbose", "config-file", "format", "log-level", "color", "input", "quiet" };
+
+    return std::format("{}-{:03x}", words[index % words.size()], index);
+}
+
+/// Parse the arguments and return the wall-clock time in seconds.
+double time_parse(const std::vector<std::string> &args, const std::vector<std::shared_ptr<optrone::option_template>> &options)
+{
+    auto start       = std::chrono::steady_clock::now();
+    auto parsed_args = optrone::parse_arguments(args, options, {});
+    auto end         = std::chrono::steady_clock::now();
+
+    if (parsed_args.size() != args.size())
+    {
+        throw std::runtime_error("Unexpected parse result");
+    }
+
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::size_t  arguments_count = argc > 1 ? std::stoul(argv[1]) : 100'000;
+        std::mt19937 engine(42);
+        std::size_t  calibrated = 0;
+
+        std::println("{:>8} {:>14} {:>14}", "names", "linear (ns)", "hashed (ns)");
+        for (std::size_t names_count = 1; names_count <= 1024; names_count *= 2)
+        {
+            std::vector<std::shared_ptr<optrone::option_template>> options;
+            for (std::size_t i = 0; i < names_count; i++)
+            {
+                options.emplace_back(std::make_shared<optrone::option_template>(optrone::option_template{
+                    .description = "Option.",
+                    .long_names  = { get_option_name(i) },
+                }));
+            }
+
+            std::uniform_int_distribution<std::size_t> pick(0, names_count - 1);
+            std::vector<std::string>                    args;
+            for (std::size_t i = 0; i < arguments_count; i++)
+            {
+                args.emplace_back("--" + get_option_name(pick(engine)));
+            }
+
+            // Alternate the structures, so that both see the same conditions
+            double linear = std::numeric_limits<double>::max();
+            double hashed = std::numeric_limits<double>::max();
+            for (std::size_t run = 0; run < runs_count; run++)
+            {
+                optrone::linear_lookup_limit.store(std::numeric_limits<std::size_t>::max(), std::memory_order_relaxed);
+                linear = std::min(linear, time_parse(args, options));
+                optrone::linear_lookup_limit.store(0, std::memory_order_relaxed);
+                hashed = std::min(hashed, time_parse(args, options));
+            }
+
+            std::println("{:>8} {:>14.1f} {:>14.1f}", names_count, linear * 1e9 / arguments_count, hashed * 1e9 / arguments_count);
+            if (hashed >= linear * hashing_margin && calibrated == names_count / 2)
+            {
+                calibrated = names_count; // Up to the first size where hashing wins
+            }
+        }
+
+        std::println("Linear scan is faster up to {} names, set `optrone::linear_lookup_limit = {};`", calibrated, calibrated);
+    }
+    catch (const std::exception &error)
+    {
+        std::println("Benchmark failed: {}", error.what());
+        return 1;
+    }
+
+    return 0;
+}
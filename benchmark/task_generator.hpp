@@ -0,0 +1,71 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This header file provides the synthetic task file generator shared by the
+/// taskmgr benchmarks and the `taskmgr_generate` tool.
+///
+/// This project is licensed under the terms of MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+
+/// Shape of the generated tasks.
+struct generator_options {
+    std::size_t   tasks_count      = 1'000'000; ///< Number of tasks
+    std::size_t   notes_count      = 2;         ///< Number of notes per task
+    std::size_t   tags_count       = 2;         ///< Number of tags per task
+    std::size_t   tags_cardinality = 100;       ///< Number of distinct tags
+    std::uint64_t seed             = 42;        ///< Seed of the random priorities and tags
+};
+
+/// Get a filename stem that identifies the generated tasks, so that tasks with
+/// a different shape are never mistaken for each other.
+inline std::string get_generated_stem(const generator_options &options)
+{
+    return std::format("tasks_{}_{}_{}_{}_{}", options.tasks_count, options.notes_count, options.tags_count,
+                       options.tags_cardinality, options.seed);
+}
+
+/// Generate the tasks file in the text format of taskmgr, with alternating
+/// states, random priorities and random tags (`tag0` to `tag<cardinality-1>`).
+/// The same options always generate the same file.
+inline void generate_tasks(const std::filesystem::path &filename, const generator_options &options)
+{
+    std::mt19937_64                            engine(options.seed);
+    std::uniform_int_distribution<std::size_t> priority(0, 9);
+    std::uniform_int_distribution<std::size_t> tag(0, options.tags_cardinality > 0 ? options.tags_cardinality - 1 : 0);
+
+    std::ofstream file(filename, std::ios::binary);
+    std::string   buffer;
+    for (std::size_t i = 0; i < options.tasks_count; i++)
+    {
+        std::format_to(std::back_inserter(buffer), "task number {};{};{};{};{}", i, i % 2, priority(engine), options.notes_count,
+                       options.tags_count);
+        for (std::size_t j = 0; j < options.notes_count; j++)
+        {
+            std::format_to(std::back_inserter(buffer), ";note {} of task {}", j, i);
+        }
+        for (std::size_t j = 0; j < options.tags_count; j++)
+        {
+            std::format_to(std::back_inserter(buffer), ";tag{}", tag(engine));
+        }
+        buffer += '\n';
+
+        if (buffer.size() >= 1024 * 1024)
+        {
+            file.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    file.write(buffer.data(), buffer.size());
+}
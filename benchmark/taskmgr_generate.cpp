@@ -0,0 +1,48 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This tool file generates a synthetic tasks file for taskmgr, to try and
+/// profile taskmgr by hand on large tasks lists.
+///
+/// Usage: `taskmgr_generate <file> [tasks count] [notes per task] [tags per task] [tag cardinality] [seed]`
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <print>
+#include <string>
+
+#include "task_generator.hpp"
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::println("Usage: {} <file> [tasks count] [notes per task] [tags per task] [tag cardinality] [seed]", argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        generator_options options;
+        if (argc > 2) options.tasks_count = std::stoul(argv[2]);
+        if (argc > 3) options.notes_count = std::stoul(argv[3]);
+        if (argc > 4) options.tags_count = std::stoul(argv[4]);
+        if (argc > 5) options.tags_cardinality = std::stoul(argv[5]);
+        if (argc > 6) options.seed = std::stoull(argv[6]);
+
+        generate_tasks(argv[1], options);
+        std::println("Generated {} tasks to `{}`.", options.tasks_count, argv[1]);
+    }
+    catch (const std::exception &error)
+    {
+        std::println("Generation failed: {}", error.what());
+        return 1;
+    }
+
+    return 0;
+}
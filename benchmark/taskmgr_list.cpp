@@ -0,0 +1,108 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This benchmark file times `taskmgr list --filter --sort` on a generated
+/// multi-million-task file with 1, 4 and all cores (`taskmgr --jobs`).
+///
+/// Usage: `taskmgr_list <taskmgr executable> [tasks count] [directory]`
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <limits>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "task_generator.hpp"
+
+#if defined(_WIN32)
+constexpr const char *null_device = "NUL";
+#else
+constexpr const char *null_device = "/dev/null";
+#endif
+
+/// Number of times each command is run, the fastest run is reported.
+constexpr std::size_t runs_count = 3;
+
+/// Run the command and return the fastest wall-clock time in seconds.
+double time_command(const std::string &command)
+{
+    double fastest = std::numeric_limits<double>::max();
+    for (std::size_t run = 0; run < runs_count; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (std::system(command.c_str()) != 0)
+        {
+            throw std::runtime_error(std::format("Command failed: {}", command));
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        fastest = std::min(fastest, std::chrono::duration<double>(end - start).count());
+    }
+    return fastest;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::println("Usage: {} <taskmgr executable> [tasks count] [directory]", argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        std::string           taskmgr     = argv[1];
+        generator_options     generator = { .tasks_count = argc > 2 ? std::stoul(argv[2]) : 5'000'000 };
+        std::filesystem::path directory = argc > 3 ? argv[3] : std::filesystem::temp_directory_path() / "optrone_benchmark";
+
+        std::filesystem::create_directories(directory);
+        std::filesystem::path text_file   = directory / (get_generated_stem(generator) + ".txt");
+        std::filesystem::path binary_file = directory / (get_generated_stem(generator) + ".tdb");
+
+        if (!std::filesystem::exists(text_file))
+        {
+            std::println("Generating {} tasks to `{}`...", generator.tasks_count, text_file.string());
+            generate_tasks(text_file, generator);
+        }
+
+        // Converts to the binary format and builds the tag index, untimed. The
+        // filename is passed as `--file=<filename>`, as an absolute path would
+        // otherwise be taken for a Microsoft-style option
+        std::string list_command = std::format("\"{}\" \"--file={}\" list --filter tag3 tag7 --limit 0", taskmgr, binary_file.string());
+        time_command(list_command);
+
+        std::vector<std::size_t> jobs_counts = { 1, 4, std::max<std::size_t>(std::thread::hardware_concurrency(), 1) };
+        std::ranges::sort(jobs_counts);
+        jobs_counts.erase(std::ranges::unique(jobs_counts).begin(), jobs_counts.end());
+
+        std::println("{:<40} {:>6} {:>10}", "command", "jobs", "time (s)");
+        for (const char *arguments : { "list --filter tag3 tag7 --sort priority", "list --sort priority" })
+        {
+            for (std::size_t jobs : jobs_counts)
+            {
+                std::string command = std::format("\"{}\" \"--file={}\" --jobs {} {} > {}", taskmgr, binary_file.string(), jobs,
+                                                  arguments, null_device);
+                std::println("{:<40} {:>6} {:>10.3f}", arguments, jobs, time_command(command));
+            }
+        }
+    }
+    catch (const std::exception &error)
+    {
+        std::println("Benchmark failed: {}", error.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,166 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This benchmark file times the main taskmgr commands (`add`, `done` and
+/// `remove` with many indices, `list --filter --sort` and `notes list`) on
+/// generated tasks files of increasing size, from 1k tasks up to the maximum
+/// tasks count (10M for the full suite).
+///
+/// Usage: `taskmgr_store <taskmgr executable> [max tasks count] [notes per task] [tags per task] [tag cardinality] [directory]`
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <limits>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "task_generator.hpp"
+
+#if defined(_WIN32)
+constexpr const char *null_device = "NUL";
+#else
+constexpr const char *null_device = "/dev/null";
+#endif
+
+/// Number of times each command is run, the fastest run is reported.
+constexpr std::size_t runs_count = 3;
+
+/// Number of indices passed to `done`, `remove` and `notes list`, spread
+/// evenly across the tasks (kept small enough for Windows' command line).
+constexpr std::size_t indices_count = 500;
+
+/// Run the command and return the fastest wall-clock time in seconds. The
+/// preparation (e.g. restoring the tasks file) runs untimed before each run.
+double time_command(const std::string &command, const std::function<void()> &prepare = {})
+{
+    double fastest = std::numeric_limits<double>::max();
+    for (std::size_t run = 0; run < runs_count; run++)
+    {
+        if (prepare)
+        {
+            prepare();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (std::system(command.c_str()) != 0)
+        {
+            throw std::runtime_error(std::format("Command failed: {}", command));
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        fastest = std::min(fastest, std::chrono::duration<double>(end - start).count());
+    }
+    return fastest;
+}
+
+/// Get the space-separated task indices spread evenly across the tasks.
+std::string get_spread_indices(std::size_t tasks_count)
+{
+    std::size_t count = std::min(tasks_count, indices_count);
+    std::string indices;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        indices += std::format(" {}", i * tasks_count / count);
+    }
+    return indices;
+}
+
+/// Copy the tasks file and its companion files (the tag index and the version
+/// lock) over the work tasks file, so that every modifying run starts from the
+/// same tasks.
+void restore_tasks(const std::filesystem::path &pristine, const std::filesystem::path &work)
+{
+    for (const char *suffix : { "", ".tags", ".lock" })
+    {
+        std::filesystem::path from = pristine.string() + suffix;
+        std::filesystem::path to   = work.string() + suffix;
+        if (std::filesystem::exists(from))
+        {
+            std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing);
+        }
+        else
+        {
+            std::filesystem::remove(to);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::println("Usage: {} <taskmgr executable> [max tasks count] [notes per task] [tags per task] [tag cardinality] [directory]",
+                     argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        std::string       taskmgr         = argv[1];
+        std::size_t       max_tasks_count = argc > 2 ? std::stoul(argv[2]) : 1'000'000;
+        generator_options generator;
+        if (argc > 3) generator.notes_count = std::stoul(argv[3]);
+        if (argc > 4) generator.tags_count = std::stoul(argv[4]);
+        if (argc > 5) generator.tags_cardinality = std::stoul(argv[5]);
+        std::filesystem::path directory = argc > 6 ? argv[6] : std::filesystem::temp_directory_path() / "optrone_benchmark";
+
+        std::filesystem::create_directories(directory);
+
+        std::println("{:>10} {:<48} {:>10}", "tasks", "command", "time (s)");
+        for (std::size_t tasks_count = 1'000; tasks_count <= max_tasks_count; tasks_count *= 10)
+        {
+            generator.tasks_count = tasks_count;
+            std::filesystem::path text_file = directory / (get_generated_stem(generator) + ".txt");
+            std::filesystem::path pristine  = directory / (get_generated_stem(generator) + ".tdb");
+            std::filesystem::path work      = directory / (get_generated_stem(generator) + ".work.tdb");
+
+            if (!std::filesystem::exists(text_file))
+            {
+                generate_tasks(text_file, generator);
+            }
+
+            // The filenames are passed as `--file=<filename>`, as an absolute
+            // path would otherwise be taken for a Microsoft-style option
+            std::string on_pristine = std::format("\"{}\" \"--file={}\"", taskmgr, pristine.string());
+            std::string on_work     = std::format("\"{}\" \"--file={}\"", taskmgr, work.string());
+            std::string indices     = get_spread_indices(tasks_count);
+
+            // Converts to the binary format and builds the tag index, untimed
+            time_command(std::format("{} list --filter tag3 --limit 0", on_pristine));
+
+            auto restore = [&] { restore_tasks(pristine, work); };
+            auto report  = [&](const std::string &name, double time) {
+                std::println("{:>10} {:<48} {:>10.3f}", tasks_count, name, time);
+            };
+
+            report("add", time_command(std::format("{} add \"benchmark task\"", on_work), restore));
+            report(std::format("done ({} indices)", std::min(tasks_count, indices_count)),
+                   time_command(std::format("{} done{}", on_work, indices), restore));
+            report(std::format("remove ({} indices)", std::min(tasks_count, indices_count)),
+                   time_command(std::format("{} remove{}", on_work, indices), restore));
+            report("list --filter tag3 tag7 --sort priority",
+                   time_command(std::format("{} list --filter tag3 tag7 --sort priority > {}", on_pristine, null_device)));
+            report(std::format("notes list ({} indices)", std::min(tasks_count, indices_count)),
+                   time_command(std::format("{} notes list{} > {}", on_pristine, indices, null_device)));
+        }
+    }
+    catch (const std::exception &error)
+    {
+        std::println("Benchmark failed: {}", error.what());
+        return 1;
+    }
+
+    return 0;
+}
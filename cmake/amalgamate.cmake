@@ -0,0 +1,44 @@
+# Amalgamate is a CMake module for generating a single-header amalgamation of
+# Optrone, used by the header-only build mode (`OPTRONE_HEADER_ONLY`).
+#
+# The headers are pasted first (in dependency order), followed by the sources.
+# Includes of Optrone's own headers and `#pragma once` are stripped, as every
+# piece is already part of the single header. The sources mark their
+# definitions with `OPTRONE_INLINE`, which expands to `inline` since the
+# amalgamation defines `OPTRONE_HEADER_ONLY`.
+#
+# The amalgamation is generated at configure time, and the inputs are added to
+# configure dependencies so that editing any of them regenerates it.
+
+function(amalgamate_add OUTPUT)
+    cmake_parse_arguments(AMALGAMATE "" "" "HEADERS;SOURCES" ${ARGN})
+
+    set(content "/// @file\n")
+    string(APPEND content "///\n")
+    string(APPEND content "/// @authors   Anstro Pleuton <https://github.com/anstropleuton>\n")
+    string(APPEND content "/// @copyright Copyright (c) 2025 Anstro Pleuton\n")
+    string(APPEND content "///\n")
+    string(APPEND content "/// This header file is the generated single-header amalgamation of Optrone.\n")
+    string(APPEND content "/// Do not edit this file, edit the headers and the sources instead.\n")
+    string(APPEND content "///\n")
+    string(APPEND content "/// This project is licensed under the terms of MIT License.\n\n")
+    string(APPEND content "#pragma once\n\n")
+    string(APPEND content "#if !defined(OPTRONE_HEADER_ONLY)\n")
+    string(APPEND content "    #define OPTRONE_HEADER_ONLY\n")
+    string(APPEND content "#endif\n")
+
+    foreach(file ${AMALGAMATE_HEADERS} ${AMALGAMATE_SOURCES})
+        file(READ "${file}" file_content)
+        file(RELATIVE_PATH file_name "${OPTRONE_SOURCE_DIR}" "${file}")
+
+        string(REGEX REPLACE "#include \"optrone/[^\"]*\"[^\n]*\n" "" file_content "${file_content}")
+        string(REGEX REPLACE "#pragma once\n" "" file_content "${file_content}")
+
+        string(APPEND content "\n// Begin ${file_name}\n\n${file_content}\n// End ${file_name}\n")
+        set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${file}")
+    endforeach()
+
+    # Avoid touching the output (and rebuilding everything) if nothing changed
+    file(WRITE "${OUTPUT}.in" "${content}")
+    configure_file("${OUTPUT}.in" "${OUTPUT}" COPYONLY)
+endfunction()
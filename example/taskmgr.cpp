@@ -14,393 +14,3641 @@
 /// ```
 ///
 /// Where text inside < and > are required and text inside [ and ] are optional.
+/// A `\`, `;` or newline inside a field is escaped with a `\` (a newline as
+/// `\n`). The first line is the header `tasks;escaped`, files without it are
+/// from before the escaping and are read verbatim.
+///
+/// The tasks.txt is a snapshot, and the modifications since the snapshot are
+/// appended to tasks.txt.journal as records, one per line, in the following
+/// format:
+///
+/// ```
+/// <record type>[;semicolon-separated values]
+/// ```
+///
+/// The first line of the journal is the header `journal;<snapshot hash>`,
+/// which ties the journal to the snapshot it applies to. The journal is
+/// compacted into the snapshot when it grows past a threshold.
 ///
 /// This project is licensed under the terms of MIT License.
 
 #include <algorithm>
+#include <bitset>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <csignal>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <exception>
+#include <filesystem>
 #include <format>
 #include <fstream>
 #include <functional>
+#include <initializer_list>
 #include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
 #include <ostream>
 #include <print>
+#include <random>
 #include <ranges>
-#include <regex>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <system_error>
+#include <thread>
 #include <tuple>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#if defined(_WIN32)
+    #include <ios>
+#else
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <sys/file.h>
+    #include <sys/mman.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/time.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
 #include "optrone/error.hpp"
 #include "optrone/help.hpp"
 #include "optrone/parser.hpp"
 #include "optrone/template.hpp"
 
+/// Hash for looking up strings by `std::string_view` without a copy.
+struct string_hash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view string) const
+    {
+        return std::hash<std::string_view>()(string);
+    }
+};
+
+/// Dictionary of the distinct tags of the loaded tasks, mapping each tag to a
+/// small integer ID. The IDs are assigned in the order the tags are first seen
+/// and are never reused, so the tasks hold the IDs instead of copies of the
+/// tags. The dictionary is part of the task store, and dropped along with it.
+struct tag_dictionary {
+    std::vector<std::string>                                                    names; ///< Tag of each ID.
+    std::unordered_map<std::string, std::uint32_t, string_hash, std::equal_to<>> ids;   ///< ID of each tag.
+};
+
+/// Guards interning while parsing tasks in parallel.
+std::mutex tags_mutex;
+
+// Defined after the task store, which holds the tag dictionary
+std::uint32_t                intern_tag(std::string_view tag);
+std::optional<std::uint32_t> find_tag(std::string_view tag);
+const std::string           &get_tag_name(std::uint32_t id);
+std::size_t                  get_tags_count();
+
+/// Tags of a task, as the sorted IDs of the tags in the tag dictionary.
+using tag_set = std::vector<std::uint32_t>;
+
+/// Add a tag to the tags of a task, keeping the IDs sorted.
+void add_tag(tag_set &tags, std::uint32_t id)
+{
+    auto position = std::ranges::lower_bound(tags, id);
+    if (position == tags.end() || *position != id)
+    {
+        tags.insert(position, id);
+    }
+}
+
+/// Remove a tag from the tags of a task, if present.
+void remove_tag(tag_set &tags, std::uint32_t id)
+{
+    auto position = std::ranges::lower_bound(tags, id);
+    if (position != tags.end() && *position == id)
+    {
+        tags.erase(position);
+    }
+}
+
 /// A single task of the task manager.
 struct task {
-    std::string                     text;             ///< Task's description.
-    bool                            done     = false; ///< Whether the task is done.
-    std::size_t                     priority = 0;     ///< Priority of the task. Higher the number, higher the priority.
-    std::vector<std::string>        notes;            ///< Notes for the task.
-    std::unordered_set<std::string> tags;             ///< Tags of the task.
+    std::string              text;             ///< Task's description.
+    bool                     done     = false; ///< Whether the task is done.
+    std::size_t              priority = 0;     ///< Priority of the task. Higher the number, higher the priority.
+    std::vector<std::string> notes;            ///< Notes for the task.
+    tag_set                  tags;             ///< Tags of the task.
+};
+
+/// Range of indices, from `begin` up to (but not including) `end`.
+struct index_range {
+    std::size_t begin = 0; ///< First index in the range.
+    std::size_t end   = 0; ///< One past the last index in the range.
 };
 
-/// Check if two unordered sets has a common element.
-template <typename set_a, typename set_b>
-bool has_any_intersection(const set_a &a, const set_b &b)
+/// Parse an index (`10`) or an inclusive range of indices (`10-5000`).
+index_range parse_index_range(std::string_view value)
+{
+    auto parse = [&](std::string_view number) {
+        std::size_t index = 0;
+        auto [end, error] = std::from_chars(number.data(), number.data() + number.size(), index);
+        if (error != std::errc() || end != number.data() + number.size() || number.empty())
+        {
+            throw std::invalid_argument(std::format("Invalid index or range of indices: {}", value));
+        }
+        return index;
+    };
+
+    std::size_t separator = value.find('-');
+    std::size_t first     = parse(value.substr(0, separator));
+    std::size_t last      = separator == std::string_view::npos ? first : parse(value.substr(separator + 1));
+    if (last < first || last == std::numeric_limits<std::size_t>::max())
+    {
+        throw std::invalid_argument(std::format("Invalid range of indices: {}", value));
+    }
+    return { first, last + 1 };
+}
+
+/// Sort the ranges of indices, and merge the overlapping and adjacent ones.
+std::vector<index_range> merge_index_ranges(std::vector<index_range> ranges)
 {
-    if (a.size() > b.size())
-        return has_any_intersection(b, a); // Iterate over smaller set
+    std::ranges::sort(ranges, {}, &index_range::begin);
+
+    // Merge the overlapping and adjacent ranges
+    std::vector<index_range> merged;
+    for (const index_range &range : ranges)
+    {
+        if (!merged.empty() && range.begin <= merged.back().end)
+        {
+            merged.back().end = std::max(merged.back().end, range.end);
+        }
+        else
+        {
+            merged.emplace_back(range);
+        }
+    }
+    return merged;
+}
 
-    for (const auto &x : a)
+/// Construct the sorted, disjoint ranges of indices from a list of indices
+/// and ranges of indices. The ranges are never expanded, so a range as large
+/// as the tasks list costs as much as a single index.
+std::vector<index_range> get_index_ranges(const std::vector<std::string> &values)
+{
+    std::vector<index_range> ranges;
+    ranges.reserve(values.size());
+    for (const std::string &value : values)
     {
-        if (b.contains(x))
-            return true;
+        ranges.emplace_back(parse_index_range(value));
     }
-    return false;
+    return merge_index_ranges(std::move(ranges));
 }
 
-/// Construct set of indices from list of values.
-std::unordered_set<std::size_t> get_indices(const std::vector<std::string> &values)
+/// Construct the sorted, disjoint ranges of indices straight from the numbers
+/// of a list parameter, without expanding its ranges.
+std::vector<index_range> get_index_ranges(const optrone::number_list &numbers)
 {
-    // Obtain indices as a set in two steps:
-    // 1. Convert values to ints.
-    // 2. Convert vector to set.
+    std::vector<index_range> ranges;
+    ranges.reserve(numbers.ranges.size());
+    for (const optrone::number_list::range &range : numbers.ranges)
+    {
+        if (range.last >= std::numeric_limits<std::size_t>::max())
+        {
+            throw std::invalid_argument(std::format("Invalid range of indices: {}-{}", range.first, range.last));
+        }
+        ranges.push_back({ .begin = range.first, .end = range.last + 1 });
+    }
+    return merge_index_ranges(std::move(ranges));
+}
 
-    // clang-format off
-    return values
-        | std::views::transform([](const std::string &value) { return std::stoul(value); })
-        | std::ranges::to<std::unordered_set>();
-    // clang-format on
+/// Format the ranges of indices as the values of a journal record, an index
+/// (`10`) or an inclusive range of indices (`10-5000`) each.
+std::vector<std::string> format_index_ranges(const std::vector<index_range> &ranges)
+{
+    std::vector<std::string> values;
+    values.reserve(ranges.size());
+    for (const index_range &range : ranges)
+    {
+        values.emplace_back(range.end - range.begin == 1 ? std::to_string(range.begin) : std::format("{}-{}", range.begin, range.end - 1));
+    }
+    return values;
 }
 
-/// Filter out indices from a list.
+/// Remove the values at the ranges of indices in a single stable compaction
+/// pass, moving the kept values down. Indices past the end are ignored.
 template <typename type>
-std::vector<type> filter_out(const std::vector<type> &values, const std::unordered_set<std::size_t> &indices)
+void remove_at(std::vector<type> &values, const std::vector<index_range> &ranges)
 {
-    // Remove tasks with those indices in four steps:
-    // 1. Obtain tasks and index of each tasks
-    // 2. Filter tasks to exclude tasks with specific indices.
-    // 3. Extract only tasks, leave index behind
-    // 4. Assign this back to the tasks.
+    auto        kept = values.begin();
+    std::size_t next = 0; // First index not yet kept or removed
 
-    // clang-format off
-    return values | std::views::enumerate
-        | std::views::filter([&](const auto &pair) { auto [index, _] = pair; return !indices.contains(index); })
-        | std::views::transform([](const auto &pair) { auto [_, value] = pair; return value; })
-        | std::ranges::to<std::vector>();
-    // clang-format on
+    // Values before the first removed index stay in place (no self-moves)
+    auto keep = [&](auto first, auto last) { kept = kept == first ? last : std::move(first, last, kept); };
+
+    for (const index_range &range : ranges)
+    {
+        keep(values.begin() + next, values.begin() + std::min(range.begin, values.size()));
+        next = std::max(next, std::min(range.end, values.size()));
+    }
+    keep(values.begin() + next, values.end());
+    values.erase(kept, values.end());
 }
 
-/// Match glob pattern with all the elements in the list.
-/// @return Matched element indices.
-std::vector<std::size_t> glob_match(std::string_view glob, const std::vector<std::string> list)
+/// Glob pattern compiled for matching in linear time.
+///
+/// Supports `*` (any string), `?` (any character), `[...]` (any character in
+/// the set, with ranges such as `a-z` and negation with `!` or `^`) and `\` to
+/// match the next character literally.
+///
+/// The literal prefix (everything before the first wildcard) is compared
+/// directly. The rest of the pattern is a sequence of single-character
+/// elements, where a `*` makes the state before an element loop on any
+/// character. It is matched by tracking every reachable state at once as a bit
+/// each (shift-and), so a character of the text is examined only once and
+/// matching never backtracks.
+struct compiled_glob {
+    std::string                prefix;             ///< Literal prefix.
+    bool                       literal     = true; ///< Whether the pattern has no wildcards at all.
+    std::size_t                words       = 0;    ///< Number of 64-bit words to hold a bit per state.
+    std::vector<std::uint64_t> accepts;            ///< For each character, the states whose element accepts it.
+    std::vector<std::uint64_t> loops;              ///< States looping on any character (after a `*`).
+    std::size_t                final_state = 0;    ///< State reached after matching every element.
+};
+
+/// Find the `]` closing the set opened by `[` at the position of the pattern.
+/// @return Position of the closing `]`, or `npos` if it does not open a set.
+std::size_t find_set_close(std::string_view pattern, std::size_t open)
 {
-    // Convert glob to regex
-    std::string pattern(glob);
+    if (pattern[open] != '[')
+    {
+        return std::string_view::npos;
+    }
 
-    pattern = std::regex_replace(pattern, std::regex(R"(([\$\^\(\)\[\]\{\}\|\\]))"), R"(\$1)"); // Sanitize
-    pattern = std::regex_replace(pattern, std::regex(R"([^\\]{0-1}(\*))"), ".*");               // Replace * with .*
-    pattern = std::regex_replace(pattern, std::regex(R"([^\\]{0-1}(\?))"), ".");                // Replace ? with .
-    pattern = "^" + pattern + "$";                                                              // Match full glob
+    std::size_t first = open + 1;
+    if (first < pattern.size() && (pattern[first] == '!' || pattern[first] == '^'))
+    {
+        first++;
+    }
 
-    std::regex               regex(pattern);
-    std::vector<std::size_t> matches;
-    for (std::size_t i = 0; i < list.size(); i++)
+    // `]` first in the set is a member, and `\` escapes the next character
+    for (std::size_t i = first; i < pattern.size(); i++)
     {
-        if (std::regex_match(list[i], regex))
+        if (pattern[i] == '\\')
+        {
+            i++;
+        }
+        else if (pattern[i] == ']' && i > first)
         {
-            matches.emplace_back(i);
+            return i;
         }
     }
 
-    return matches;
+    return std::string_view::npos;
 }
 
-/// Read all the tasks from a file.
-std::vector<task> read_tasks(const std::string &filename)
+/// Compile the glob pattern.
+compiled_glob compile_glob(std::string_view pattern)
 {
-    std::ifstream ifile(filename);
-    if (!ifile)
+    compiled_glob                 glob;
+    std::vector<std::bitset<256>> elements; // Characters accepted by each element
+    std::vector<bool>             loops(1); // Whether each state loops on any character
+
+    for (std::size_t i = 0; i < pattern.size(); i++)
     {
-        return {};
+        std::bitset<256> chars;
+
+        if (pattern[i] == '*')
+        {
+            loops.back() = true;
+            glob.literal = false;
+            continue;
+        }
+        else if (pattern[i] == '?')
+        {
+            chars.set();
+        }
+        else if (std::size_t close = find_set_close(pattern, i); close != std::string_view::npos)
+        {
+            std::size_t j      = i + 1;
+            bool        negate = pattern[j] == '!' || pattern[j] == '^';
+            if (negate) j++;
+
+            // Obtain the character at j, unescaping it
+            auto next_char = [&](std::size_t &j) -> unsigned char {
+                if (pattern[j] == '\\') j++;
+                return pattern[j];
+            };
+
+            for (; j < close; j++)
+            {
+                unsigned char first = next_char(j);
+                if (j + 2 < close && pattern[j + 1] == '-')
+                {
+                    j += 2;
+                    unsigned char last = next_char(j);
+                    for (unsigned c = first; c <= last; c++) chars.set(c);
+                }
+                else
+                {
+                    chars.set(first);
+                }
+            }
+
+            if (negate) chars.flip();
+            i = close;
+        }
+        else
+        {
+            if (pattern[i] == '\\' && i + 1 < pattern.size())
+            {
+                i++;
+            }
+
+            // Literal characters before any wildcard go to the prefix
+            if (glob.literal)
+            {
+                glob.prefix += pattern[i];
+                continue;
+            }
+
+            chars.set(static_cast<unsigned char>(pattern[i]));
+        }
+
+        glob.literal = false;
+        elements.emplace_back(chars);
+        loops.emplace_back(false);
     }
 
-    std::vector<task> tasks;
+    // State j is reached after matching the first j elements
+    glob.final_state = elements.size();
+    glob.words       = elements.size() / 64 + 1;
+    glob.accepts.resize(256 * glob.words);
+    glob.loops.resize(glob.words);
 
-    std::string line;
-    while (std::getline(ifile, line))
+    for (std::size_t j = 0; j < elements.size(); j++)
     {
-        auto tokens = line | std::views::split(';') | std::ranges::to<std::vector<std::string>>();
-        if (tokens.size() < 5)
+        for (std::size_t c = 0; c < 256; c++)
         {
-            throw std::runtime_error("Invalid tokens");
+            if (elements[j][c]) glob.accepts[c * glob.words + j / 64] |= std::uint64_t(1) << (j % 64);
         }
+    }
 
-        task task;
-        task.text     = tokens[0];
-        task.done     = std::stoi(tokens[1]) != 0;
-        task.priority = std::stoul(tokens[2]);
+    for (std::size_t j = 0; j < loops.size(); j++)
+    {
+        if (loops[j]) glob.loops[j / 64] |= std::uint64_t(1) << (j % 64);
+    }
+
+    return glob;
+}
+
+/// Match the text against the compiled glob, as a whole.
+bool glob_matches(const compiled_glob &glob, std::string_view text)
+{
+    // Literal prefix fast path
+    if (!text.starts_with(glob.prefix))
+    {
+        return false;
+    }
+    text.remove_prefix(glob.prefix.size());
+
+    if (glob.literal)
+    {
+        return text.empty();
+    }
 
-        std::size_t notes_count = std::stoul(tokens[3]);
-        std::size_t tags_count  = std::stoul(tokens[4]);
+    std::size_t   final_word = glob.final_state / 64;
+    std::uint64_t final_bit  = std::uint64_t(1) << (glob.final_state % 64);
 
-        if (tokens.size() != notes_count + tags_count + 5)
+    // Common case of up to 63 elements, in a single word
+    if (glob.words == 1)
+    {
+        std::uint64_t states = 1;
+        for (unsigned char c : text)
         {
-            throw std::runtime_error("Invalid tokens");
+            states = ((states & glob.accepts[c]) << 1) | (states & glob.loops[0]);
+            if (!states) return false;
+        }
+        return states & final_bit;
+    }
+
+    std::vector<std::uint64_t> states(glob.words);
+    states[0] = 1;
+    for (unsigned char c : text)
+    {
+        const std::uint64_t *accepts = &glob.accepts[c * glob.words];
+
+        std::uint64_t carry = 0;
+        std::uint64_t any   = 0;
+        for (std::size_t w = 0; w < glob.words; w++)
+        {
+            std::uint64_t advanced = states[w] & accepts[w];
+            states[w]              = (advanced << 1) | carry | (states[w] & glob.loops[w]);
+            carry                  = advanced >> 63;
+            any                   |= states[w];
         }
 
-        task.notes.insert(task.notes.begin(), tokens.begin() + 5, tokens.end() - tags_count);
-        task.tags.insert(tokens.begin() + 5 + notes_count, tokens.end());
-        tasks.emplace_back(task);
+        if (!any) return false;
     }
+    return states[final_word] & final_bit;
+}
 
-    return tasks;
+/// Match the text against any of the compiled globs.
+bool any_glob_matches(const std::vector<compiled_glob> &globs, std::string_view text)
+{
+    return std::ranges::any_of(globs, [&](const compiled_glob &glob) { return glob_matches(glob, text); });
 }
 
-/// Write all the tasks to a file.
-void write_tasks(const std::vector<task> &tasks, const std::string &filename)
+// Parallelism
+
+/// Number of threads to use for the listings, set by `--jobs`.
+std::size_t jobs_count = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+/// Do not split work into chunks smaller than this, as starting a thread costs
+/// more than processing them.
+constexpr std::size_t parallel_min_chunk = 16 * 1024;
+
+/// Split `0..count` into contiguous chunks, one per job.
+/// @return Boundaries of the chunks, the first being 0 and the last `count`.
+std::vector<std::size_t> split_into_chunks(std::size_t count)
 {
-    std::ofstream ofile(filename);
-    if (!ofile)
+    std::size_t chunks = std::clamp<std::size_t>(count / parallel_min_chunk, 1, jobs_count);
+
+    std::vector<std::size_t> bounds(chunks + 1);
+    for (std::size_t c = 0; c <= chunks; c++)
     {
-        return;
+        bounds[c] = count * c / chunks;
+    }
+    return bounds;
+}
+
+/// Run `function(job)` for each job in `0..jobs`, each on its own thread, and
+/// rethrow the first exception thrown by any of them.
+template <typename function_type>
+void run_in_parallel(std::size_t jobs, function_type function)
+{
+    std::vector<std::exception_ptr> errors(jobs);
+    auto                            run = [&](std::size_t job) {
+        try
+        {
+            function(job);
+        }
+        catch (...)
+        {
+            errors[job] = std::current_exception();
+        }
+    };
+
+    {
+        std::vector<std::jthread> threads;
+        for (std::size_t job = 1; job < jobs; job++)
+        {
+            threads.emplace_back(run, job);
+        }
+        run(0); // Use the calling thread too
+    } // Join the threads
+
+    for (const std::exception_ptr &error : errors)
+    {
+        if (error) std::rethrow_exception(error);
     }
+}
 
-    for (const task &task : tasks)
+/// Run `function(begin, end)` over contiguous chunks of `0..count` in parallel.
+template <typename function_type>
+void parallel_for(std::size_t count, function_type function)
+{
+    std::vector<std::size_t> bounds = split_into_chunks(count);
+    run_in_parallel(bounds.size() - 1, [&](std::size_t c) { function(bounds[c], bounds[c + 1]); });
+}
+
+/// Sort the values in parallel and keep only the first `limit` of them.
+///
+/// The chunks are (partially) sorted in parallel and then merged pairwise,
+/// with the merges of each round also in parallel. The comparison must be a
+/// total order for the result to be deterministic regardless of the number of
+/// jobs.
+template <typename value_type, typename compare_type>
+void parallel_sort(std::vector<value_type> &values, std::size_t limit, compare_type compare)
+{
+    limit = std::min(limit, values.size());
+
+    std::vector<std::size_t> bounds = split_into_chunks(values.size());
+    std::vector<std::size_t> middles(bounds.size() - 1);
+
+    run_in_parallel(middles.size(), [&](std::size_t c) {
+        auto first = values.begin() + bounds[c];
+        auto last  = values.begin() + bounds[c + 1];
+
+        // Only the first `limit` values of each chunk can make it to the result
+        middles[c] = bounds[c] + std::min<std::size_t>(limit, last - first);
+        std::partial_sort(first, values.begin() + middles[c], last, compare);
+    });
+
+    // Gather the sorted part of each chunk to the front (chunks already in
+    // place, such as the first one, are not moved onto themselves)
+    std::vector<std::size_t> runs = { 0 };
+    for (std::size_t c = 0; c < middles.size(); c++)
     {
-        std::string line = std::format("{};{};{};{};{}", task.text, task.done ? 1 : 0, task.priority, task.notes.size(), task.tags.size());
-        if (!task.notes.empty()) line += ";" + (std::views::join_with(task.notes, std::string(";")) | std::ranges::to<std::string>());
-        if (!task.tags.empty()) line += ";" + (std::views::join_with(task.tags, std::string(";")) | std::ranges::to<std::string>());
-        ofile << line << std::endl;
+        if (runs.back() != bounds[c])
+        {
+            std::move(values.begin() + bounds[c], values.begin() + middles[c], values.begin() + runs.back());
+        }
+        runs.emplace_back(runs.back() + middles[c] - bounds[c]);
+    }
+    values.resize(runs.back());
+
+    // Merge the runs pairwise until one is left
+    while (runs.size() > 2)
+    {
+        run_in_parallel((runs.size() - 1) / 2, [&](std::size_t p) {
+            std::inplace_merge(values.begin() + runs[2 * p], values.begin() + runs[2 * p + 1], values.begin() + runs[2 * p + 2], compare);
+        });
+
+        std::vector<std::size_t> merged;
+        for (std::size_t r = 0; r < runs.size(); r += 2)
+        {
+            merged.emplace_back(runs[r]);
+        }
+        if (merged.back() != runs.back())
+        {
+            merged.emplace_back(runs.back());
+        }
+        runs = std::move(merged);
     }
+
+    values.resize(limit);
 }
 
-// Setting up templates
+/// Read the whole file.
+/// @return Empty string if the file does not exist.
+std::string read_file(const std::string &filename)
+{
+    std::ifstream ifile(filename, std::ios::binary);
+    if (!ifile)
+    {
+        return {};
+    }
 
-// --help
-auto help_option = std::make_shared<optrone::option_template>(optrone::option_template{
-    .description = "Show help message.",
-    .short_names = { 'h', '?' },
-    .long_names  = { "help" },
-});
+    return std::string(std::istreambuf_iterator<char>(ifile), std::istreambuf_iterator<char>());
+}
 
-// --version
-auto version_option = std::make_shared<optrone::option_template>(optrone::option_template{
-    .description = "Show version information.",
-    .short_names = { 'v' },
-    .long_names  = { "version" },
-});
+/// Memory mapping of a whole file (read into memory where mapping is not
+/// available).
+struct mapped_file {
+    char       *data = nullptr; ///< Content of the file (null if it does not exist or is empty).
+    std::size_t size = 0;       ///< Size of the file.
+#if defined(_WIN32)
+    std::string buffer; ///< Content of the file read into memory.
+#endif
+
+    /// Map the file, leaving the content empty if the file does not exist.
+    explicit mapped_file(const std::string &filename)
+    {
+#if defined(_WIN32)
+        buffer = read_file(filename);
+        data   = buffer.data();
+        size   = buffer.size();
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return;
+        }
 
-// --file
-auto file_option = std::make_shared<optrone::option_template>(optrone::option_template{
-    .description = "File for the list of tasks to save and load.",
-    .short_names = { 'f' },
-    .long_names  = { "file" },
-    .params      = { "filename" },
-    .defaults    = { "tasks.txt" },
-});
+        struct stat status;
+        if (::fstat(fd, &status) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Failed to stat " + filename);
+        }
 
-// add
-auto add_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description = "Add a task to the tasks list.",
-    .names       = { "add" },
-    .params      = { "text" },
-});
+        if (status.st_size > 0)
+        {
+            void *address = ::mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address == MAP_FAILED)
+            {
+                ::close(fd);
+                throw std::runtime_error("Failed to map " + filename);
+            }
 
-// remove
-auto remove_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description = "Remove task(s) from the tasks list.",
-    .names       = { "remove" },
-    .params      = { "task index" },
-    .variadic    = true,
-});
+            ::madvise(address, status.st_size, MADV_SEQUENTIAL);
+            data = static_cast<char *>(address);
+            size = status.st_size;
+        }
 
-// auto-remove
-auto auto_remove_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description = "Automatically remove completed tasks.",
-    .names       = { "auto-remove", "remove-done" },
-});
+        ::close(fd);
+#endif
+    }
 
-// list --include-notes
-auto list_include_notes_option = std::make_shared<optrone::option_template>(optrone::option_template{
-    .description = "Sort tasks with notes included",
-    .long_names  = { "include-notes" },
-});
+    ~mapped_file()
+    {
+#if !defined(_WIN32)
+        if (data)
+        {
+            ::munmap(data, size);
+        }
+#endif
+    }
 
-// list --filter
-auto list_filter_option = std::make_shared<optrone::option_template>(optrone::option_template{
-    .description = "Filter task by tags",
-    .short_names = { 'f' },
-    .long_names  = { "filter" },
-    .params      = { "tags" },
-    .variadic    = true,
-});
+    mapped_file(const mapped_file &)            = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    /// Obtain the content of the file.
+    std::string_view content() const
+    {
+        return std::string_view(data, size);
+    }
+};
+
+/// Write data to a file with a single write, followed by syncing the data to
+/// the disk.
+/// @param append Append to the file instead of truncating it.
+void write_file_synced(const std::string &filename, std::string_view data, bool append)
+{
+#if defined(_WIN32)
+    std::ofstream ofile(filename, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    ofile.write(data.data(), data.size());
+    ofile.flush();
+    if (!ofile)
+    {
+        throw std::runtime_error("Failed to write " + filename);
+    }
+#else
+    int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), 0644);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Failed to open " + filename);
+    }
+
+    // A single write, unless the kernel decides to write partially
+    std::size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t result = ::write(fd, data.data() + written, data.size() - written);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result < 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Failed to write " + filename);
+        }
+        written += result;
+    }
+
+    #if defined(__linux__)
+    int synced = ::fdatasync(fd);
+    #else
+    int synced = ::fsync(fd);
+    #endif
+
+    ::close(fd);
+    if (synced != 0)
+    {
+        throw std::runtime_error("Failed to sync " + filename);
+    }
+#endif
+}
+
+/// Obtain a temporary filename next to the file, unique to the writer, to be
+/// renamed over the file once written.
+std::string get_temporary_filename(const std::string &filename)
+{
+    return std::format("{}.{:x}.tmp", filename, std::random_device {}());
+}
+
+/// Exclusive lock of the writers of the tasks file, which also holds the
+/// version of the tasks file (`<tasks file>.lock`).
+///
+/// Writers load the tasks and prepare their modifications without the lock,
+/// then take the lock only to check that the version is unchanged, publish
+/// their modifications and increment the version. Readers never take it.
+/// @note Not available on Windows, where the writers are not coordinated.
+struct writer_lock {
+    int fd = -1; ///< File descriptor of the lock file.
+
+    explicit writer_lock(const std::string &filename)
+    {
+#if !defined(_WIN32)
+        fd = ::open((filename + ".lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "Failed to open the lock of " + filename);
+        }
+
+        while (::flock(fd, LOCK_EX) < 0)
+        {
+            if (errno != EINTR)
+            {
+                ::close(fd);
+                throw std::system_error(errno, std::generic_category(), "Failed to lock " + filename);
+            }
+        }
+#endif
+    }
+
+    ~writer_lock()
+    {
+#if !defined(_WIN32)
+        ::close(fd); // Releases the lock
+#endif
+    }
+
+    writer_lock(const writer_lock &)            = delete;
+    writer_lock &operator=(const writer_lock &) = delete;
+
+    /// Read the version of the tasks file.
+    std::uint64_t get_version() const
+    {
+        std::uint64_t version = 0;
+#if !defined(_WIN32)
+        if (::pread(fd, &version, sizeof(version), 0) != sizeof(version))
+        {
+            version = 0;
+        }
+#endif
+        return version;
+    }
+
+    /// Set the version of the tasks file.
+    void set_version(std::uint64_t version)
+    {
+#if !defined(_WIN32)
+        if (::pwrite(fd, &version, sizeof(version), 0) != sizeof(version))
+        {
+            throw std::system_error(errno, std::generic_category(), "Failed to write the version");
+        }
+#endif
+    }
+};
+
+/// Read the version of the tasks file, incremented by every commit, without
+/// locking. A file that was never committed to is version 0.
+std::uint64_t read_tasks_version(const std::string &filename)
+{
+    std::uint64_t version = 0;
+#if !defined(_WIN32)
+    int fd = ::open((filename + ".lock").c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0)
+    {
+        if (::pread(fd, &version, sizeof(version), 0) != sizeof(version))
+        {
+            version = 0;
+        }
+        ::close(fd);
+    }
+#endif
+    return version;
+}
+
+/// Hash the content using FNV-1a. Used to tie the journal to its snapshot.
+std::uint64_t hash_content(std::string_view content)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (char c : content)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/// Escape `\\`, `;` and newlines in a field, so that it can be joined with
+/// other fields into a line.
+std::string escape_field(std::string_view field)
+{
+    if (field.find_first_of("\\;\n") == std::string_view::npos)
+    {
+        return std::string(field); // Nothing to escape, the common case
+    }
+
+    std::string escaped;
+    escaped.reserve(field.size() + 8);
+    for (char c : field)
+    {
+        if (c == '\\' || c == ';' || c == '\n')
+        {
+            escaped += '\\';
+        }
+        escaped += c == '\n' ? 'n' : c;
+    }
+    return escaped;
+}
+
+/// Unescape a field escaped by `escape_field`.
+std::string unescape_field(std::string_view field)
+{
+    if (field.find('\\') == std::string_view::npos)
+    {
+        return std::string(field);
+    }
+
+    std::string unescaped;
+    unescaped.reserve(field.size());
+    for (std::size_t i = 0; i < field.size(); i++)
+    {
+        if (field[i] == '\\' && i + 1 < field.size())
+        {
+            i++;
+            unescaped += field[i] == 'n' ? '\n' : field[i];
+        }
+        else
+        {
+            unescaped += field[i];
+        }
+    }
+    return unescaped;
+}
+
+/// Join the fields into a line, escaping them.
+std::string join_fields(const std::vector<std::string> &fields)
+{
+    std::string line;
+    for (const std::string &field : fields)
+    {
+        if (&field != &fields.front()) line += ';';
+        line += escape_field(field);
+    }
+    return line;
+}
+
+/// Find the end of the first field in the line, the first `;` that is not
+/// escaped (or the end of the line).
+/// @param escaped False for the lines of tasks files written before the fields
+/// were escaped, where every `;` ends a field.
+std::size_t find_field_end(std::string_view line, bool escaped = true)
+{
+    const void *end    = std::memchr(line.data(), ';', line.size());
+    std::size_t length = end ? static_cast<const char *>(end) - line.data() : line.size();
+    if (!escaped || !std::memchr(line.data(), '\\', length))
+    {
+        return length; // No escapes, the common case
+    }
+
+    std::size_t pos = 0;
+    while (pos < line.size() && line[pos] != ';')
+    {
+        pos += line[pos] == '\\' ? 2 : 1;
+    }
+    return std::min(pos, line.size());
+}
+
+/// Count the semicolon-separated fields in the line.
+std::size_t count_fields(std::string_view line, bool escaped = true)
+{
+    std::size_t count = 1;
+    for (std::size_t end = find_field_end(line, escaped); end < line.size(); end = find_field_end(line, escaped))
+    {
+        line.remove_prefix(end + 1);
+        count++;
+    }
+    return count;
+}
+
+/// Obtain the next line and advance past it.
+/// @note Assumes the content is not empty.
+std::string_view next_line(std::string_view &content)
+{
+    const void *eol    = std::memchr(content.data(), '\n', content.size());
+    std::size_t length = eol ? static_cast<const char *>(eol) - content.data() : content.size();
+
+    std::string_view line = content.substr(0, length);
+    content.remove_prefix(std::min(length + 1, content.size()));
+    return line;
+}
+
+/// Obtain the next semicolon-separated field (still escaped) and advance past
+/// it.
+/// @note Assumes the line has at least one more field.
+std::string_view next_field(std::string_view &line, bool escaped = true)
+{
+    std::size_t length = find_field_end(line, escaped);
+
+    std::string_view field = line.substr(0, length);
+    line.remove_prefix(std::min(length + 1, line.size()));
+    return field;
+}
+
+/// Split a line into semicolon-separated fields, unescaping them.
+std::vector<std::string> split_fields(std::string_view line)
+{
+    std::vector<std::string> fields;
+    while (true)
+    {
+        std::size_t end = find_field_end(line);
+        fields.emplace_back(unescape_field(line.substr(0, end)));
+        if (end == line.size())
+        {
+            return fields;
+        }
+        line.remove_prefix(end + 1);
+    }
+}
+
+/// Convert a whole field to a number.
+template <typename type>
+type parse_number(std::string_view field)
+{
+    type value        = 0;
+    auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (error != std::errc() || end != field.data() + field.size())
+    {
+        throw std::runtime_error("Invalid number");
+    }
+    return value;
+}
+
+/// First line of the tasks files whose fields are escaped. It has too few
+/// fields to be a task, so files written before it are told apart.
+constexpr std::string_view tasks_header = "tasks;escaped";
+
+/// Parse all the tasks from the content of a tasks file.
+/// @note Each field is copied once, directly from the content.
+std::vector<task> parse_tasks(std::string_view content)
+{
+    std::vector<task> tasks;
+    tasks.reserve(std::ranges::count(content, '\n'));
+
+    // Files without the header were written before the fields were escaped,
+    // and are read verbatim (they are escaped when next compacted)
+    bool escaped = content.substr(0, content.find('\n')) == tasks_header;
+    if (escaped)
+    {
+        next_line(content);
+    }
+
+    auto take_field = [&](std::string_view &line) {
+        std::string_view field = next_field(line, escaped);
+        return escaped ? unescape_field(field) : std::string(field);
+    };
+
+    while (!content.empty())
+    {
+        std::string_view line = next_line(content);
+        if (line.empty())
+        {
+            continue;
+        }
+
+        std::size_t fields_count = count_fields(line, escaped);
+        if (fields_count < 5)
+        {
+            throw std::runtime_error("Invalid tokens");
+        }
+
+        task task;
+        task.text     = take_field(line);
+        task.done     = parse_number<int>(next_field(line, escaped)) != 0;
+        task.priority = parse_number<std::size_t>(next_field(line, escaped));
+
+        std::size_t notes_count = parse_number<std::size_t>(next_field(line, escaped));
+        std::size_t tags_count  = parse_number<std::size_t>(next_field(line, escaped));
+
+        if (fields_count != notes_count + tags_count + 5)
+        {
+            throw std::runtime_error("Invalid tokens");
+        }
+
+        task.notes.reserve(notes_count);
+        for (std::size_t j = 0; j < notes_count; j++)
+        {
+            task.notes.emplace_back(take_field(line));
+        }
+
+        for (std::size_t j = 0; j < tags_count; j++)
+        {
+            add_tag(task.tags, intern_tag(take_field(line)));
+        }
+
+        tasks.emplace_back(std::move(task));
+    }
+
+    return tasks;
+}
+
+/// Format all the tasks as the content of a tasks file.
+std::string format_tasks(const std::vector<task> &tasks)
+{
+    std::string content = std::string(tasks_header) + "\n";
+
+    for (const task &task : tasks)
+    {
+        content += std::format("{};{};{};{};{}", escape_field(task.text), task.done ? 1 : 0, task.priority, task.notes.size(), task.tags.size());
+        for (const std::string &note : task.notes) content += ";" + escape_field(note);
+        for (std::uint32_t tag : task.tags) content += ";" + escape_field(get_tag_name(tag));
+        content += "\n";
+    }
+
+    return content;
+}
+
+/// Header of the binary tasks file.
+///
+/// The binary tasks file is column-oriented, so that the commands read only
+/// the columns they touch. The header is followed by a fixed-size record for
+/// each task (its state and priority), then by the texts, the notes and the
+/// tags columns, and finally by the tag dictionary. Each column is an offset
+/// table (the offset of each task's data, plus the end of the data) followed
+/// by the data: the texts as they are, the notes of each task as strings
+/// prefixed with their 32-bit length, and the tags of each task as 32-bit
+/// indices into the tag dictionary (length-prefixed strings as well). All the
+/// integers are in native byte order.
+struct binary_header {
+    char          magic[8]        = { 'T', 'A', 'S', 'K', 'S', 'B', 'I', 'N' }; ///< Identifies the binary tasks file.
+    std::uint64_t version         = 2;                                          ///< Version of the format.
+    std::uint64_t tasks_count     = 0;                                          ///< Number of records following the header.
+    std::uint64_t texts_size      = 0;                                          ///< Size of the data of the texts column.
+    std::uint64_t notes_size      = 0;                                          ///< Size of the data of the notes column.
+    std::uint64_t tags_size       = 0;                                          ///< Size of the data of the tags column.
+    std::uint64_t dictionary_size = 0;                                          ///< Size of the tag dictionary.
+    std::uint64_t generation      = 0;                                          ///< Random ID of the rewrite that wrote the file (0 before it was set), kept by the patches of the records.
+};
+
+/// Fixed-size record of a task in the binary tasks file.
+struct binary_record {
+    std::uint64_t priority    = 0;  ///< Priority of the task.
+    std::uint8_t  done        = 0;  ///< Whether the task is done.
+    std::uint8_t  reserved[7] = {}; ///< Padding.
+};
+
+static_assert(sizeof(binary_header) == 64 && sizeof(binary_record) == 16, "Binary tasks file layout must be packed");
+
+/// Header of the binary tasks files of version 1, where the strings of each
+/// task (text, then notes, then tags) were stored consecutively in a heap
+/// following the records. Such files are upgraded as they are read.
+struct legacy_binary_header {
+    char          magic[8]    = {}; ///< Identifies the binary tasks file.
+    std::uint64_t version     = 1;  ///< Version of the format.
+    std::uint64_t tasks_count = 0;  ///< Number of records following the header.
+    std::uint64_t heap_size   = 0;  ///< Size of the string heap following the records.
+};
+
+/// Fixed-size record of a task in the binary tasks files of version 1.
+struct legacy_binary_record {
+    std::uint64_t priority    = 0;  ///< Priority of the task.
+    std::uint64_t heap_offset = 0;  ///< Offset of the task's strings in the heap.
+    std::uint32_t notes_count = 0;  ///< Number of notes.
+    std::uint32_t tags_count  = 0;  ///< Number of tags.
+    std::uint8_t  done        = 0;  ///< Whether the task is done.
+    std::uint8_t  reserved[7] = {}; ///< Padding.
+};
+
+static_assert(sizeof(legacy_binary_header) == 32 && sizeof(legacy_binary_record) == 32,
+              "Legacy binary tasks file layout must be packed");
+
+/// Extension of the tasks file that selects the binary format.
+constexpr std::string_view binary_extension = ".tdb";
+
+/// Check if the tasks file is in the binary format (by its extension).
+bool is_binary_tasks_file(const std::string &filename)
+{
+    return std::filesystem::path(filename).extension() == binary_extension;
+}
+
+/// Read the header of the binary tasks file and validate the layout. The
+/// header of a file of version 1 is returned with only its magic, version and
+/// tasks count set.
+binary_header read_binary_header(std::string_view content)
+{
+    // The magic and the version are common to all the versions
+    legacy_binary_header legacy;
+    if (content.size() < sizeof(legacy))
+    {
+        throw std::runtime_error("Invalid binary tasks file");
+    }
+
+    std::memcpy(&legacy, content.data(), sizeof(legacy));
+    if (std::string_view(legacy.magic, sizeof(legacy.magic)) != std::string_view(binary_header().magic, sizeof(legacy.magic)))
+    {
+        throw std::runtime_error("Invalid binary tasks file");
+    }
+
+    binary_header header;
+    if (legacy.version == legacy_binary_header().version)
+    {
+        std::size_t available = content.size() - sizeof(legacy);
+        if (legacy.tasks_count > available / sizeof(legacy_binary_record) ||
+            legacy.heap_size != available - legacy.tasks_count * sizeof(legacy_binary_record))
+        {
+            throw std::runtime_error("Invalid binary tasks file");
+        }
+
+        header.version     = legacy.version;
+        header.tasks_count = legacy.tasks_count;
+        return header;
+    }
+
+    if (legacy.version != header.version || content.size() < sizeof(header))
+    {
+        throw std::runtime_error("Invalid binary tasks file");
+    }
+
+    std::memcpy(&header, content.data(), sizeof(header));
+    std::size_t available = content.size() - sizeof(header);
+
+    // Each task takes a record and an entry in each of the three offset tables
+    constexpr std::size_t task_size = sizeof(binary_record) + 3 * sizeof(std::uint64_t);
+    if (header.tasks_count > available / task_size)
+    {
+        throw std::runtime_error("Invalid binary tasks file");
+    }
+
+    available -= header.tasks_count * task_size;
+    if (available < 3 * sizeof(std::uint64_t) ||
+        header.texts_size > available ||
+        header.notes_size > available - header.texts_size ||
+        header.tags_size > available - header.texts_size - header.notes_size ||
+        header.dictionary_size != available - 3 * sizeof(std::uint64_t) - header.texts_size - header.notes_size - header.tags_size)
+    {
+        throw std::runtime_error("Invalid binary tasks file");
+    }
+
+    return header;
+}
+
+/// Obtain the next length-prefixed string from the heap and advance past it.
+std::string_view next_string(std::string_view &heap)
+{
+    std::uint32_t length = 0;
+    if (heap.size() < sizeof(length))
+    {
+        throw std::runtime_error("Invalid binary tasks file");
+    }
+
+    std::memcpy(&length, heap.data(), sizeof(length));
+    if (heap.size() - sizeof(length) < length)
+    {
+        throw std::runtime_error("Invalid binary tasks file");
+    }
+
+    std::string_view string = heap.substr(sizeof(length), length);
+    heap.remove_prefix(sizeof(length) + length);
+    return string;
+}
+
+/// Append a length-prefixed string to the heap.
+void append_string(std::string &heap, std::string_view string)
+{
+    std::uint32_t length = string.size();
+    heap.append(reinterpret_cast<const char *>(&length), sizeof(length));
+    heap.append(string);
+}
+
+/// Parse the tasks from the content of a binary tasks file of version 1.
+std::vector<task> parse_legacy_binary_tasks(std::string_view content)
+{
+    legacy_binary_header header;
+    std::memcpy(&header, content.data(), sizeof(header));
+
+    std::string_view records = content.substr(sizeof(header), header.tasks_count * sizeof(legacy_binary_record));
+    std::string_view heap    = content.substr(sizeof(header) + records.size());
+
+    std::vector<task> tasks(header.tasks_count);
+    for (std::size_t i = 0; i < tasks.size(); i++)
+    {
+        legacy_binary_record record;
+        std::memcpy(&record, records.data() + i * sizeof(record), sizeof(record));
+
+        if (record.heap_offset > heap.size())
+        {
+            throw std::runtime_error("Invalid binary tasks file");
+        }
+
+        std::string_view strings = heap.substr(record.heap_offset);
+
+        task &task    = tasks[i];
+        task.text     = next_string(strings);
+        task.done     = record.done != 0;
+        task.priority = record.priority;
+
+        task.notes.reserve(record.notes_count);
+        for (std::uint32_t j = 0; j < record.notes_count; j++)
+        {
+            task.notes.emplace_back(next_string(strings));
+        }
+
+        for (std::uint32_t j = 0; j < record.tags_count; j++)
+        {
+            add_tag(task.tags, intern_tag(next_string(strings)));
+        }
+    }
+
+    return tasks;
+}
+
+/// Format all the tasks as the content of a binary tasks file.
+std::string format_binary_tasks(const std::vector<task> &tasks)
+{
+    constexpr std::uint32_t no_file_tag = std::numeric_limits<std::uint32_t>::max();
+
+    std::vector<binary_record> records;
+    std::vector<std::uint64_t> text_offsets = { 0 };
+    std::vector<std::uint64_t> note_offsets = { 0 };
+    std::vector<std::uint64_t> tag_offsets  = { 0 };
+    std::string                texts;
+    std::string                notes;
+    std::string                tags;
+    std::string                dictionary;
+    records.reserve(tasks.size());
+    text_offsets.reserve(tasks.size() + 1);
+    note_offsets.reserve(tasks.size() + 1);
+    tag_offsets.reserve(tasks.size() + 1);
+
+    // Only the tags in use go to the file's dictionary, numbered by their
+    // first use
+    std::vector<std::uint32_t> file_tags(get_tags_count(), no_file_tag);
+    std::uint32_t              file_tags_count = 0;
+
+    for (const task &task : tasks)
+    {
+        records.push_back({ .priority = task.priority, .done = task.done });
+
+        texts.append(task.text);
+        text_offsets.emplace_back(texts.size());
+
+        for (const std::string &note : task.notes) append_string(notes, note);
+        note_offsets.emplace_back(notes.size());
+
+        for (std::uint32_t tag : task.tags)
+        {
+            if (file_tags[tag] == no_file_tag)
+            {
+                file_tags[tag] = file_tags_count++;
+                append_string(dictionary, get_tag_name(tag));
+            }
+            tags.append(reinterpret_cast<const char *>(&file_tags[tag]), sizeof(std::uint32_t));
+        }
+        tag_offsets.emplace_back(tags.size());
+    }
+
+    binary_header header;
+    header.tasks_count     = tasks.size();
+    header.texts_size      = texts.size();
+    header.notes_size      = notes.size();
+    header.tags_size       = tags.size();
+    header.dictionary_size = dictionary.size();
+    header.generation      = std::uint64_t(std::random_device {}()) << 32 | std::random_device {}();
+
+    auto append_offsets = [](std::string &content, const std::vector<std::uint64_t> &offsets) {
+        content.append(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(std::uint64_t));
+    };
+
+    std::string content;
+    content.reserve(sizeof(header) + records.size() * sizeof(binary_record) + 3 * text_offsets.size() * sizeof(std::uint64_t) +
+                    texts.size() + notes.size() + tags.size() + dictionary.size());
+    content.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    content.append(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(binary_record));
+    append_offsets(content, text_offsets);
+    content.append(texts);
+    append_offsets(content, note_offsets);
+    content.append(notes);
+    append_offsets(content, tag_offsets);
+    content.append(tags);
+    content.append(dictionary);
+    return content;
+}
+
+/// Read the generation of the binary tasks file, which the indices built from
+/// the file are tied to, as a rewrite to the same size is not told apart by
+/// the size.
+/// @return 0 if the file does not exist or was written without a generation.
+std::uint64_t read_binary_generation(const std::string &filename)
+{
+    mapped_file file(filename);
+    return file.content().empty() ? 0 : read_binary_header(file.content()).generation;
+}
+
+/// Columns of the tasks to read from a binary tasks file. The state and the
+/// priority are always read.
+struct task_columns {
+    bool text  = true; ///< Read the text.
+    bool notes = true; ///< Read the notes.
+    bool tags  = true; ///< Read the tags.
+};
+
+/// Column of a binary tasks file.
+struct binary_column {
+    std::string_view offsets; ///< Offset of each task's data, followed by the end of the data.
+    std::string_view data;    ///< Data of all the tasks.
+
+    /// Obtain the data of the task at the index.
+    std::string_view at(std::size_t index) const
+    {
+        std::uint64_t bounds[2] = {};
+        std::memcpy(bounds, offsets.data() + index * sizeof(std::uint64_t), sizeof(bounds));
+
+        if (bounds[0] > bounds[1] || bounds[1] > data.size())
+        {
+            throw std::runtime_error("Invalid binary tasks file");
+        }
+
+        return data.substr(bounds[0], bounds[1] - bounds[0]);
+    }
+};
+
+/// Columns of the content of a binary tasks file, to read the tasks (or some
+/// of their columns) without touching the rest of the file. A file of version
+/// 1 is upgraded to the current version in memory.
+struct binary_tasks {
+    std::string                upgraded;        ///< Content upgraded from version 1, if any.
+    std::size_t                tasks_count = 0; ///< Number of tasks.
+    std::string_view           records;         ///< Records of the tasks.
+    binary_column              texts;           ///< Texts column.
+    binary_column              notes;           ///< Notes column.
+    binary_column              tags;            ///< Tags column.
+    std::vector<std::uint32_t> tag_ids;         ///< ID of each tag of the file's tag dictionary.
+
+    /// Split the content into the columns. The content must outlive this.
+    explicit binary_tasks(std::string_view content)
+    {
+        if (content.empty())
+        {
+            return;
+        }
+
+        binary_header header = read_binary_header(content);
+        if (header.version == legacy_binary_header().version)
+        {
+            upgraded = format_binary_tasks(parse_legacy_binary_tasks(content));
+            content  = upgraded;
+            header   = read_binary_header(content);
+        }
+
+        auto take = [&](std::size_t size) {
+            std::string_view section = content.substr(0, size);
+            content.remove_prefix(size);
+            return section;
+        };
+
+        std::size_t offsets_size = (header.tasks_count + 1) * sizeof(std::uint64_t);
+
+        take(sizeof(header));
+        tasks_count   = header.tasks_count;
+        records       = take(tasks_count * sizeof(binary_record));
+        texts.offsets = take(offsets_size);
+        texts.data    = take(header.texts_size);
+        notes.offsets = take(offsets_size);
+        notes.data    = take(header.notes_size);
+        tags.offsets  = take(offsets_size);
+        tags.data     = take(header.tags_size);
+
+        // Interned here once, so that the tasks can be parsed in parallel
+        std::string_view dictionary = take(header.dictionary_size);
+        while (!dictionary.empty())
+        {
+            tag_ids.emplace_back(intern_tag(next_string(dictionary)));
+        }
+    }
+
+    // The columns may view the upgraded content
+    binary_tasks(const binary_tasks &)            = delete;
+    binary_tasks &operator=(const binary_tasks &) = delete;
+
+    /// Parse the columns of the task at the index.
+    task parse(std::size_t index, task_columns columns = {}) const
+    {
+        binary_record record;
+        std::memcpy(&record, records.data() + index * sizeof(record), sizeof(record));
+
+        task task;
+        task.done     = record.done != 0;
+        task.priority = record.priority;
+
+        if (columns.text)
+        {
+            task.text = texts.at(index);
+        }
+
+        if (columns.notes)
+        {
+            std::string_view strings = notes.at(index);
+            while (!strings.empty())
+            {
+                task.notes.emplace_back(next_string(strings));
+            }
+        }
+
+        if (columns.tags)
+        {
+            std::string_view ids = tags.at(index);
+            if (ids.size() % sizeof(std::uint32_t) != 0)
+            {
+                throw std::runtime_error("Invalid binary tasks file");
+            }
+
+            task.tags.reserve(ids.size() / sizeof(std::uint32_t));
+            for (std::size_t j = 0; j < ids.size(); j += sizeof(std::uint32_t))
+            {
+                std::uint32_t id = 0;
+                std::memcpy(&id, ids.data() + j, sizeof(id));
+                if (id >= tag_ids.size())
+                {
+                    throw std::runtime_error("Invalid binary tasks file");
+                }
+                add_tag(task.tags, tag_ids[id]);
+            }
+        }
+
+        return task;
+    }
+};
+
+/// Parse the tasks from the content of a binary tasks file.
+/// @param indices Parse only the tasks at these indices, or all of them if null.
+/// @param columns Columns of the tasks to parse, the others are left empty.
+std::vector<task> parse_binary_tasks(std::string_view content, const std::vector<std::size_t> *indices = nullptr,
+                                     task_columns columns = {})
+{
+    binary_tasks      file(content);
+    std::vector<task> tasks(indices ? indices->size() : file.tasks_count);
+
+    parallel_for(tasks.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t j = begin; j < end; j++)
+        {
+            std::size_t index = indices ? (*indices)[j] : j;
+            if (index >= file.tasks_count)
+            {
+                throw std::out_of_range("Task index out of range");
+            }
+            tasks[j] = file.parse(index, columns);
+        }
+    });
+
+    return tasks;
+}
+
+/// Construct a journal record of a type and its values.
+std::vector<std::string> make_record(std::string_view type, const std::vector<std::string> &values)
+{
+    std::vector<std::string> record = { std::string(type) };
+    record.insert(record.end(), values.begin(), values.end());
+    return record;
+}
+
+/// Apply a journal record (a single modification) to the tasks.
+void apply_record(std::vector<task> &tasks, const std::vector<std::string> &record)
+{
+    const std::string             &type = record.at(0);
+    const std::vector<std::string> values(record.begin() + 1, record.end());
+
+    if (type == "add")
+    {
+        tasks.emplace_back(values.at(0));
+    }
+    else if (type == "remove")
+    {
+        remove_at(tasks, get_index_ranges(values));
+    }
+    else if (type == "auto-remove")
+    {
+        std::erase_if(tasks, [](const task &task) { return task.done; });
+    }
+    else if (type == "done" || type == "undo")
+    {
+        // Validate everything before modifying anything
+        std::vector<index_range> ranges = get_index_ranges(values);
+        if (!ranges.empty() && ranges.back().end > tasks.size())
+        {
+            throw std::out_of_range("Task index out of range");
+        }
+
+        for (const index_range &range : ranges)
+        {
+            for (std::size_t j = range.begin; j < range.end; j++)
+            {
+                tasks[j].done = type == "done";
+            }
+        }
+    }
+    else if (type == "text")
+    {
+        tasks.at(std::stoul(values.at(0))).text = values.at(1);
+    }
+    else if (type == "priority")
+    {
+        tasks.at(std::stoul(values.at(0))).priority = std::stoul(values.at(1));
+    }
+    else if (type == "notes-add")
+    {
+        task &task = tasks.at(std::stoul(values.at(0)));
+        task.notes.insert(task.notes.end(), values.begin() + 1, values.end());
+    }
+    else if (type == "notes-remove")
+    {
+        task &task = tasks.at(std::stoul(values.at(0)));
+        remove_at(task.notes, get_index_ranges(std::vector(values.begin() + 1, values.end()))); // Exclude first value (task index)
+    }
+    else if (type == "tags-add")
+    {
+        task &task = tasks.at(std::stoul(values.at(0)));
+        for (const std::string &tag : values | std::views::drop(1))
+        {
+            add_tag(task.tags, intern_tag(tag));
+        }
+    }
+    else if (type == "tags-remove")
+    {
+        task &task = tasks.at(std::stoul(values.at(0)));
+        for (const std::string &tag : values | std::views::drop(1))
+        {
+            if (std::optional<std::uint32_t> id = find_tag(tag))
+            {
+                remove_tag(task.tags, *id);
+            }
+        }
+    }
+    else
+    {
+        throw std::runtime_error("Invalid journal record");
+    }
+}
+
+// Setting up templates
+
+// --help
+auto help_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "Show help message.",
+    .short_names = { 'h', '?' },
+    .long_names  = { "help" },
+});
+
+// --version
+auto version_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "Show version information.",
+    .short_names = { 'v' },
+    .long_names  = { "version" },
+});
+
+// --file
+auto file_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "File for the list of tasks to save and load. Use `.tdb` extension for the binary format.",
+    .short_names = { 'f' },
+    .long_names  = { "file" },
+    .params      = { "filename" },
+    .defaults    = { "tasks.txt" },
+});
+
+// --jobs
+auto jobs_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "Number of threads to use for listing the tasks. Defaults to the number of cores.",
+    .short_names = { 'j' },
+    .long_names  = { "jobs" },
+    .params      = { "count" },
+});
+
+// --serve
+auto serve_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "Serve the commands of the clients on a Unix socket, keeping the tasks loaded. "
+                   "Commands are forwarded to the server when `TASKMGR_SOCKET` is set to its socket.",
+    .long_names  = { "serve" },
+    .params      = { "socket" },
+});
+
+// add
+auto add_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description = "Add a task to the tasks list.",
+    .names       = { "add" },
+    .params      = { "text" },
+});
+
+// remove --glob
+auto remove_glob_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "Remove tasks whose text or tags match the glob patterns (*, ?, [...])",
+    .short_names = { 'g' },
+    .long_names  = { "glob" },
+    .params      = { "patterns" },
+    .variadic    = true,
+});
+
+// remove
+auto remove_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description    = "Remove task(s) from the tasks list: `remove <task index> ...` by indices or ranges of indices "
+                      "(e.g. 10-5000 or 1,4,7-9), or `remove --glob <patterns> ...` by glob patterns.",
+    .names          = { "remove" },
+    .variadic       = true, // No required parameter, as `--glob` may select the tasks instead
+    .params_kind    = optrone::param_kind::list,
+    .nested_options = { remove_glob_option },
+});
+
+// auto-remove
+auto auto_remove_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description = "Automatically remove completed tasks.",
+    .names       = { "auto-remove", "remove-done" },
+});
+
+// list --include-notes
+auto list_include_notes_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "Sort tasks with notes included",
+    .long_names  = { "include-notes" },
+});
+
+// list --filter
+auto list_filter_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "Filter task by tags",
+    .short_names = { 'f' },
+    .long_names  = { "filter" },
+    .params      = { "tags" },
+    .variadic    = true,
+});
+
+// list --glob
+auto list_glob_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "Filter tasks whose text or tags match the glob patterns (*, ?, [...])",
+    .short_names = { 'g' },
+    .long_names  = { "glob" },
+    .params      = { "patterns" },
+    .variadic    = true,
+});
+
+// list --sort
+auto list_sort_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "Sort tasks in specific order (index, priority, completion, ascending, descending, notes, tags)",
+    .short_names = { 's' },
+    .long_names  = { "sort" },
+    .params      = { "key" },
+    .defaults    = { "priority" },
+});
+
+// list --limit
+auto list_limit_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "List only the first tasks in the sorted order",
+    .short_names = { 'n' },
+    .long_names  = { "limit" },
+    .params      = { "count" },
+});
+
+// list --offset
+auto list_offset_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "Skip the first tasks in the sorted order",
+    .short_names = { 'o' },
+    .long_names  = { "offset" },
+    .params      = { "count" },
+});
+
+// list
+auto list_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description    = "List task(s) from the tasks list.",
+    .names          = { "list" },
+    .nested_options = { list_include_notes_option, list_filter_option, list_glob_option, list_sort_option, list_limit_option, list_offset_option },
+});
+
+// search --limit
+auto search_limit_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "List only the first matching tasks",
+    .short_names = { 'n' },
+    .long_names  = { "limit" },
+    .params      = { "count" },
+});
+
+// search
+auto search_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description    = "Search tasks whose text or notes contain the query (ignoring case).",
+    .names          = { "search" },
+    .params         = { "query" },
+    .nested_options = { search_limit_option },
+});
+
+// done
+auto done_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description = "Mark task(s) as done, by indices or ranges of indices (e.g. 10-5000 or 1,4,7-9).",
+    .names       = { "done" },
+    .params      = { "task index" },
+    .variadic    = true,
+    .params_kind = optrone::param_kind::list,
+});
+
+// undo
+auto undo_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description = "Unmark task(s) as done, by indices or ranges of indices (e.g. 10-5000 or 1,4,7-9).",
+    .names       = { "undo" },
+    .params      = { "task index" },
+    .variadic    = true,
+    .params_kind = optrone::param_kind::list,
+});
+
+// edit text
+auto edit_text_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description = "Edit task's text.",
+    .names       = { "text" },
+    .params      = { "task index", "text" },
+});
+
+// edit priority
+auto edit_priority_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description = "Edit task's priority.",
+    .names       = { "priority" },
+    .params      = { "task index", "priority" },
+    .defaults    = { "0" }, // Zero priority if none provided
+});
+
+// edit
+auto edit_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description        = "Edit the task.",
+    .names              = { "edit" },
+    .nested_subcommands = { edit_text_subcommand, edit_priority_subcommand },
+});
+
+// notes add
+auto notes_add_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description = "Add note(s) to the task.",
+    .names       = { "add" },
+    .params      = { "task index", "notes" },
+    .variadic    = true,
+});
+
+// notes remove
+auto notes_remove_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description = "Remove note(s) from the task.",
+    .names       = { "remove" },
+    .params      = { "task index", "note index" },
+    .variadic    = true,
+});
+
+// notes list --sort
+auto notes_list_sort_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "Sort notes in specific order (index, ascending, descending)",
+    .short_names = { 's' },
+    .long_names  = { "sort" },
+    .params      = { "key" },
+    .defaults    = { "ascending" },
+});
+
+// notes list --limit
+auto notes_list_limit_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "List only the first notes of each task in the sorted order",
+    .short_names = { 'n' },
+    .long_names  = { "limit" },
+    .params      = { "count" },
+});
+
+// notes list --offset
+auto notes_list_offset_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "Skip the first notes of each task in the sorted order",
+    .short_names = { 'o' },
+    .long_names  = { "offset" },
+    .params      = { "count" },
+});
+
+// notes list
+auto notes_list_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description    = "List notes from the task(s).",
+    .names          = { "list" },
+    .params         = { "task index" },
+    .variadic       = true,
+    .params_kind    = optrone::param_kind::list,
+    .nested_options = { notes_list_sort_option, notes_list_limit_option, notes_list_offset_option },
+});
+
+// notes
+auto notes_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description        = "Edit notes of the task",
+    .names              = { "notes" },
+    .nested_subcommands = { notes_add_subcommand, notes_remove_subcommand, notes_list_subcommand }
+});
+
+// tags add
+auto tags_add_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description = "Add tag(s) to the task.",
+    .names       = { "add" },
+    .params      = { "task index", "tags" },
+    .variadic    = true,
+});
+
+// tags remove
+auto tags_remove_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description = "Remove tag(s) from the task.",
+    .names       = { "remove" },
+    .params      = { "task index", "tags" },
+    .variadic    = true,
+});
+
+// tags list --limit
+auto tags_list_limit_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "List only the first tags of each task",
+    .short_names = { 'n' },
+    .long_names  = { "limit" },
+    .params      = { "count" },
+});
+
+// tags list --offset
+auto tags_list_offset_option = std::make_shared<optrone::option_template>(optrone::option_template{
+    .description = "Skip the first tags of each task",
+    .short_names = { 'o' },
+    .long_names  = { "offset" },
+    .params      = { "count" },
+});
+
+// tags list
+auto tags_list_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description    = "List tags from the task(s).",
+    .names          = { "list" },
+    .params         = { "task index" },
+    .variadic       = true,
+    .params_kind    = optrone::param_kind::list,
+    .nested_options = { tags_list_limit_option, tags_list_offset_option },
+});
+
+// tags
+auto tags_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+    .description        = "Edit tags of the task",
+    .names              = { "tags" },
+    .nested_subcommands = { tags_add_subcommand, tags_remove_subcommand, tags_list_subcommand }
+});
+
+// Templates
+
+std::vector options = {
+    help_option,
+    version_option,
+    file_option,
+    jobs_option,
+    serve_option,
+};
+
+std::vector subcommands = {
+    add_subcommand,
+    remove_subcommand,
+    auto_remove_subcommand,
+    list_subcommand,
+    search_subcommand,
+    done_subcommand,
+    undo_subcommand,
+    edit_subcommand,
+    notes_subcommand,
+    tags_subcommand
+};
+
+/// Inverted index from tags to the indices of the tasks with those tags,
+/// persisted next to the tasks file as `<tasks file>.tags`.
+///
+/// The index remembers the state of the tasks file it reflects. For the text
+/// format, it is the snapshot hash and the journal size, so an index that lags
+/// behind is caught up by applying only the newer journal records. For the
+/// binary format, it is the generation of the file, which the patches of the
+/// records keep, as they never touch the tags.
+struct tag_index {
+    std::unordered_map<std::string, std::vector<std::size_t>> postings;           ///< Sorted task indices for each tag.
+    std::size_t                                               tasks_count  = 0;     ///< Number of tasks the index covers.
+    std::uint64_t                                             snapshot     = 0;     ///< Snapshot hash (text) or generation (binary).
+    std::size_t                                               journal_size = 0;     ///< Size of the journal the index reflects (text).
+    bool                                                      loaded       = false; ///< Whether the index is loaded and up to date.
+};
+
+/// Secondary index of the tasks by priority and by completion state, persisted
+/// next to the tasks file as `<tasks file>.order`, so that the listings sorted
+/// by them read the tasks in order instead of sorting them all.
+///
+/// Like the tag index, it remembers the state of the tasks file it reflects.
+/// For the binary format, the version of the tasks file is remembered as well,
+/// as the patches of the records change the priorities and the states (they
+/// update the index along with the tasks).
+struct order_index {
+    std::vector<std::uint64_t> priorities;            ///< Priority of each task.
+    std::vector<std::uint64_t> by_priority;           ///< Task indices by priority (highest first), then by index.
+    std::vector<std::uint64_t> done_tasks;            ///< Sorted indices of the done tasks (the rest are pending).
+    std::uint64_t              snapshot     = 0;     ///< Snapshot hash (text) or generation (binary).
+    std::size_t                journal_size = 0;     ///< Size of the journal the index reflects (text).
+    std::uint64_t              version      = 0;     ///< Version of the tasks file the index reflects (binary).
+    bool                       loaded       = false; ///< Whether the index is loaded and up to date.
+};
+
+/// Header of the persisted order index. It is followed by the priorities, the
+/// task indices by priority and the indices of the done tasks, all 64-bit
+/// integers in native byte order.
+struct order_index_header {
+    char          magic[8]     = { 'T', 'A', 'S', 'K', 'S', 'O', 'R', 'D' }; ///< Identifies the order index.
+    std::uint64_t tasks_count  = 0;                                          ///< Number of tasks the index covers.
+    std::uint64_t done_count   = 0;                                          ///< Number of done tasks.
+    std::uint64_t snapshot     = 0;                                          ///< Snapshot hash (text) or generation (binary).
+    std::uint64_t journal_size = 0;                                          ///< Size of the journal the index reflects (text).
+    std::uint64_t version      = 0;                                          ///< Version of the tasks file the index reflects (binary).
+};
+
+/// Trigram index of the texts and the notes of the tasks for `search`,
+/// persisted next to the tasks file as `<tasks file>.search`.
+///
+/// Each trigram (three consecutive bytes, ASCII-lowercased) maps to the
+/// indices of the tasks whose text or notes contain it. Changed texts and
+/// removed notes only add postings and never remove them, so the postings may
+/// list tasks that no longer contain the trigram; searches check the
+/// candidates against the tasks anyway. Like the tag index, it remembers the
+/// state of the tasks file it reflects.
+struct search_index {
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> postings;           ///< Sorted task indices for each trigram.
+    std::size_t                                                   tasks_count  = 0;     ///< Number of tasks the index covers.
+    std::uint64_t                                                 snapshot     = 0;     ///< Snapshot hash (text) or generation (binary).
+    std::size_t                                                   journal_size = 0;     ///< Size of the journal the index reflects (text).
+    bool                                                          loaded       = false; ///< Whether the index is loaded and up to date.
+};
+
+/// Header of the persisted search index. It is followed by an entry for each
+/// trigram, sorted by the trigram, and then by the posting lists, each encoded
+/// as the differences of the consecutive task indices in LEB128.
+struct search_index_header {
+    char          magic[8]       = { 'T', 'A', 'S', 'K', 'S', 'T', 'R', 'I' }; ///< Identifies the search index.
+    std::uint64_t tasks_count    = 0;                                          ///< Number of tasks the index covers.
+    std::uint64_t trigrams_count = 0;                                          ///< Number of entries following the header.
+    std::uint64_t snapshot       = 0;                                          ///< Snapshot hash (text) or generation (binary).
+    std::uint64_t journal_size   = 0;                                          ///< Size of the journal the index reflects (text).
+};
+
+/// Entry of a trigram in the persisted search index.
+struct search_index_entry {
+    std::uint32_t trigram = 0; ///< Trigram, the three bytes in the lowest bytes.
+    std::uint32_t count   = 0; ///< Number of task indices in the posting list.
+    std::uint64_t offset  = 0; ///< Offset of the posting list after the entries.
+};
+
+static_assert(sizeof(search_index_header) == 40 && sizeof(search_index_entry) == 16, "Search index layout must be packed");
+
+/// In-memory store of the tasks. It is loaded lazily once and written back once
+/// per process (or at explicit checkpoints), regardless of how many handlers
+/// or indices operate on it.
+struct task_store {
+    std::vector<task>                     tasks;                 ///< All the tasks (snapshot with the journal replayed).
+    std::vector<std::vector<std::string>> pending;               ///< Journal records not yet written.
+    std::uint64_t                         snapshot_hash = 0;     ///< Hash of the snapshot the journal applies to.
+    std::size_t                           journal_size  = 0;     ///< Size of the valid part of the journal (0 if none).
+    std::uint64_t                         version       = 0;     ///< Version of the tasks file the tasks were loaded from.
+    bool                                  loaded        = false; ///< Whether the tasks were read from the tasks file.
+    bool                                  binary        = false; ///< Whether the tasks file is in the binary format.
+    bool                                  compact       = false; ///< Whether to compact instead of appending to the journal.
+    tag_index                             tags_index;            ///< Tag index, built or loaded on first use.
+    order_index                           orders_index;          ///< Order index, built or loaded on first use.
+    search_index                          trigrams_index;        ///< Search index, built or loaded on first use.
+    tag_dictionary                        tags_dictionary;       ///< Tags of the tasks, by their IDs.
+};
+
+/// Compact the journal into the snapshot once it grows past this size.
+constexpr std::size_t journal_compaction_threshold = 1024 * 1024;
+
+/// Give up committing after conflicting with other writers this many times.
+constexpr std::size_t commit_attempts_max = 16;
+
+/// Tasks file used unless `--file` is given.
+constexpr std::string_view default_tasks_file = "tasks.txt";
+
+// Globals
+
+task_store  store;
+std::string tasks_file   = std::string(default_tasks_file);
+std::string program_name = "./optrone_usage_example";
+bool        serving      = false; ///< Whether running commands for the clients (`--serve`).
+
+/// Get the ID of a tag, adding the tag to the dictionary if it is new.
+/// @note Safe to call from parallel jobs, unlike `get_tag_name`.
+std::uint32_t intern_tag(std::string_view tag)
+{
+    std::lock_guard lock(tags_mutex);
+
+    auto it = store.tags_dictionary.ids.find(tag);
+    if (it != store.tags_dictionary.ids.end())
+    {
+        return it->second;
+    }
+
+    std::uint32_t id = store.tags_dictionary.names.size();
+    store.tags_dictionary.names.emplace_back(tag);
+    store.tags_dictionary.ids.emplace(tag, id);
+    return id;
+}
+
+/// Get the ID of a tag, without adding it to the dictionary.
+std::optional<std::uint32_t> find_tag(std::string_view tag)
+{
+    auto it = store.tags_dictionary.ids.find(tag);
+    return it != store.tags_dictionary.ids.end() ? std::optional(it->second) : std::nullopt;
+}
+
+/// Get the tag of an ID.
+const std::string &get_tag_name(std::uint32_t id)
+{
+    return store.tags_dictionary.names[id];
+}
+
+/// Get the number of tags in the dictionary, which is one past the highest ID.
+std::size_t get_tags_count()
+{
+    return store.tags_dictionary.names.size();
+}
+
+/// Thrown instead of exiting while serving, to end only the current command.
+struct command_exit {
+    int status; ///< Exit status of the command.
+};
+
+/// Exit with the status, or end only the current command while serving.
+[[noreturn]] void exit_command(int status)
+{
+    if (serving)
+    {
+        throw command_exit { status };
+    }
+
+    std::exit(status);
+}
+
+/// Replay the journal over the tasks loaded from the snapshot.
+void replay_journal(std::string_view journal)
+{
+    std::string header = std::format("journal;{}", store.snapshot_hash);
+
+    std::size_t pos = 0;
+    while (pos < journal.size())
+    {
+        std::size_t eol = journal.find('\n', pos);
+        if (eol == std::string_view::npos)
+        {
+            // Torn record from an interrupted write, rewrite everything on next save
+            store.compact = true;
+            break;
+        }
+
+        std::string_view line = journal.substr(pos, eol - pos);
+        if (pos == 0 && line != header)
+        {
+            // Stale journal that was already compacted into the snapshot
+            break;
+        }
+
+        if (pos != 0)
+        {
+            apply_record(store.tasks, split_fields(line));
+        }
+
+        pos                = eol + 1;
+        store.journal_size = pos;
+    }
+}
+
+/// Load the tasks from the text tasks file and its journal.
+void load_text_tasks(const std::string &filename)
+{
+    mapped_file snapshot(filename);
+    store.tasks         = parse_tasks(snapshot.content());
+    store.snapshot_hash = hash_content(snapshot.content());
+
+    mapped_file journal(filename + ".journal");
+    replay_journal(journal.content());
+}
+
+/// Write all the tasks as a new binary tasks file, replacing it atomically.
+void write_binary_tasks()
+{
+    std::string temporary = get_temporary_filename(tasks_file);
+    write_file_synced(temporary, format_binary_tasks(store.tasks), false);
+    std::filesystem::rename(temporary, tasks_file);
+}
+
+/// Obtain the tasks for reading, loading them on first use.
+std::vector<task> &load_tasks()
+{
+    if (store.loaded)
+    {
+        return store.tasks;
+    }
+
+    // Read the version first, so a commit racing with the loading is caught
+    store.loaded  = true;
+    store.binary  = is_binary_tasks_file(tasks_file);
+    store.version = read_tasks_version(tasks_file);
+
+    if (!store.binary)
+    {
+        load_text_tasks(tasks_file);
+        return store.tasks;
+    }
+
+    // Convert from the text tasks file of the same name, if there is one
+    std::string text_file = std::filesystem::path(tasks_file).replace_extension(".txt").string();
+    if (!std::filesystem::exists(tasks_file) && (std::filesystem::exists(text_file) || std::filesystem::exists(text_file + ".journal")))
+    {
+        load_text_tasks(text_file);
+        write_binary_tasks();
+        return store.tasks;
+    }
+
+    mapped_file file(tasks_file);
+    store.tasks = parse_binary_tasks(file.content());
+    return store.tasks;
+}
+
+/// Compare the task indices of the order index by priority (highest first),
+/// then by index.
+auto by_priority_order(const order_index &index)
+{
+    return [&](std::uint64_t a, std::uint64_t b) {
+        return index.priorities[a] != index.priorities[b] ? index.priorities[a] > index.priorities[b] : a < b;
+    };
+}
+
+/// Apply a journal record to the order index, moving only the modified tasks.
+/// @return False if the record shifts the task indices (or refers to tasks the
+/// index does not cover), requiring a rebuild.
+bool apply_record_to_order_index(order_index &index, const std::vector<std::string> &record)
+{
+    const std::string &type = record.at(0);
+
+    if (type == "add")
+    {
+        std::uint64_t task_index = index.priorities.size();
+        index.priorities.emplace_back(0);
+        index.by_priority.insert(std::ranges::lower_bound(index.by_priority, task_index, by_priority_order(index)), task_index);
+    }
+    else if (type == "remove" || type == "auto-remove")
+    {
+        return false;
+    }
+    else if (type == "done" || type == "undo")
+    {
+        std::vector<index_range> ranges = get_index_ranges(std::vector(record.begin() + 1, record.end()));
+        if (!ranges.empty() && ranges.back().end > index.priorities.size())
+        {
+            return false;
+        }
+
+        std::vector<std::uint64_t> marked;
+        for (const index_range &range : ranges)
+        {
+            for (std::size_t j = range.begin; j < range.end; j++)
+            {
+                marked.emplace_back(j);
+            }
+        }
+
+        // Merge the marked tasks into (or out of) the done tasks in one pass
+        std::vector<std::uint64_t> done_tasks;
+        if (type == "done")
+            std::ranges::set_union(index.done_tasks, marked, std::back_inserter(done_tasks));
+        else
+            std::ranges::set_difference(index.done_tasks, marked, std::back_inserter(done_tasks));
+        index.done_tasks = std::move(done_tasks);
+    }
+    else if (type == "priority")
+    {
+        std::size_t task_index = std::stoul(record.at(1));
+        if (task_index >= index.priorities.size())
+        {
+            return false;
+        }
+
+        // Move the task from its position for the old priority to the new one
+        index.by_priority.erase(std::ranges::lower_bound(index.by_priority, task_index, by_priority_order(index)));
+        index.priorities[task_index] = std::stoul(record.at(2));
+        index.by_priority.insert(std::ranges::lower_bound(index.by_priority, task_index, by_priority_order(index)), task_index);
+    }
+
+    return true;
+}
+
+/// Build the order index from the loaded tasks.
+void build_order_index()
+{
+    order_index             &index = store.orders_index;
+    const std::vector<task> &tasks = store.tasks;
+
+    index.priorities.resize(tasks.size());
+    index.done_tasks.clear();
+    for (std::size_t i = 0; i < tasks.size(); i++)
+    {
+        index.priorities[i] = tasks[i].priority;
+        if (tasks[i].done)
+        {
+            index.done_tasks.emplace_back(i);
+        }
+    }
+
+    index.by_priority.resize(tasks.size());
+    std::iota(index.by_priority.begin(), index.by_priority.end(), 0);
+    parallel_sort(index.by_priority, index.by_priority.size(), by_priority_order(index));
+
+    index.snapshot     = store.binary ? read_binary_generation(tasks_file) : store.snapshot_hash;
+    index.journal_size = store.binary ? 0 : store.journal_size;
+    index.version      = store.version;
+    index.loaded       = true;
+}
+
+/// Write the order index, replacing it atomically.
+void write_order_index()
+{
+    const order_index &index = store.orders_index;
+
+    order_index_header header = {
+        .tasks_count  = index.priorities.size(),
+        .done_count   = index.done_tasks.size(),
+        .snapshot     = index.snapshot,
+        .journal_size = index.journal_size,
+        .version      = index.version,
+    };
+
+    auto append_array = [](std::string &content, const std::vector<std::uint64_t> &values) {
+        content.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(std::uint64_t));
+    };
+
+    std::string content;
+    content.reserve(sizeof(header) + (index.priorities.size() * 2 + index.done_tasks.size()) * sizeof(std::uint64_t));
+    content.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    append_array(content, index.priorities);
+    append_array(content, index.by_priority);
+    append_array(content, index.done_tasks);
+
+    std::string temporary = get_temporary_filename(tasks_file + ".order");
+    write_file_synced(temporary, content, false);
+    std::filesystem::rename(temporary, tasks_file + ".order");
+}
+
+/// Read the order index written by `write_order_index`.
+/// @return False if there is no valid order index.
+bool read_order_index()
+{
+    order_index &index = store.orders_index;
+
+    mapped_file      file(tasks_file + ".order");
+    std::string_view content = file.content();
+
+    order_index_header header;
+    if (content.size() < sizeof(header))
+    {
+        return false;
+    }
+
+    std::memcpy(&header, content.data(), sizeof(header));
+    content.remove_prefix(sizeof(header));
+
+    std::size_t values_count = content.size() / sizeof(std::uint64_t);
+    if (std::string_view(header.magic, sizeof(header.magic)) != std::string_view(order_index_header().magic, sizeof(header.magic)) ||
+        content.size() % sizeof(std::uint64_t) != 0 ||
+        header.tasks_count > values_count / 2 ||
+        header.done_count != values_count - header.tasks_count * 2)
+    {
+        return false;
+    }
+
+    auto read_array = [&](std::vector<std::uint64_t> &values, std::size_t count) {
+        values.resize(count);
+        std::memcpy(values.data(), content.data(), count * sizeof(std::uint64_t));
+        content.remove_prefix(count * sizeof(std::uint64_t));
+    };
+
+    read_array(index.priorities, header.tasks_count);
+    read_array(index.by_priority, header.tasks_count);
+    read_array(index.done_tasks, header.done_count);
+    index.snapshot     = header.snapshot;
+    index.journal_size = header.journal_size;
+    index.version      = header.version;
+    return true;
+}
+
+/// Obtain the order index, reading it (and catching it up with the journal) or
+/// rebuilding it from the tasks.
+order_index &load_order_index()
+{
+    order_index &index = store.orders_index;
+    if (index.loaded)
+    {
+        return index;
+    }
+
+    // Modifications not yet written are only reflected by the tasks in memory
+    if (!store.pending.empty())
+    {
+        build_order_index();
+        return index;
+    }
+
+    bool binary = is_binary_tasks_file(tasks_file);
+    bool valid  = read_order_index();
+
+    if (valid && binary)
+    {
+        std::uint64_t version = store.loaded ? store.version : read_tasks_version(tasks_file);
+        valid = std::filesystem::exists(tasks_file) && index.snapshot == read_binary_generation(tasks_file) && index.version == version;
+    }
+    else if (valid)
+    {
+        load_tasks();
+        valid = index.snapshot == store.snapshot_hash && index.journal_size <= store.journal_size;
+
+        // Catch up with the journal records written after the index
+        if (valid && index.journal_size < store.journal_size)
+        {
+            mapped_file      journal(tasks_file + ".journal");
+            std::string_view records = journal.content().substr(index.journal_size, store.journal_size - index.journal_size);
+
+            while (valid && !records.empty())
+            {
+                valid = apply_record_to_order_index(index, split_fields(next_line(records)));
+            }
+
+            index.journal_size = store.journal_size;
+            if (valid) write_order_index();
+        }
+    }
+
+    if (!valid)
+    {
+        index = {};
+        load_tasks();
+        build_order_index();
+        write_order_index();
+    }
+
+    index.loaded = true;
+    return index;
+}
+
+/// Rebuild the order index after the tasks file was rewritten, if there is
+/// one.
+void rebuild_order_index()
+{
+    if (store.orders_index.loaded || std::filesystem::exists(tasks_file + ".order"))
+    {
+        build_order_index();
+        write_order_index();
+    }
+}
+
+/// Mark the loaded order index as reflecting the journal once the pending
+/// modifications, which `journal` applied to it, are appended to it.
+void publish_order_index()
+{
+    if (store.orders_index.loaded)
+    {
+        store.orders_index.journal_size = store.journal_size;
+    }
+}
+
+/// Apply a patch of the binary tasks file to the order index, if there is one,
+/// while holding the writer lock.
+/// @param version Version of the tasks file before the modification.
+/// @param snapshot Generation of the binary tasks file.
+void patch_order_index(const std::vector<std::string> &record, std::uint64_t version, std::uint64_t snapshot)
+{
+    order_index &index = store.orders_index;
+    if (!index.loaded && !read_order_index())
+    {
+        return;
+    }
+
+    // A stale index is dropped, and rebuilt when it is used next
+    if (index.version != version || index.snapshot != snapshot || !apply_record_to_order_index(index, record))
+    {
+        index = {};
+        return;
+    }
+
+    index.version = version + 1;
+    index.loaded  = true;
+    write_order_index();
+}
+
+/// Apply a modification directly to the records of the binary tasks file,
+/// without loading the tasks. The records are patched in a copy of the file
+/// that then replaces it, as the readers do not lock and must only ever see a
+/// complete file.
+/// @return False if the modification cannot be applied to the records.
+bool patch_binary_tasks(const std::vector<std::string> &record)
+{
+    const std::string &type = record.at(0);
+    if ((type != "done" && type != "undo" && type != "priority") || !std::filesystem::exists(tasks_file))
+    {
+        return false;
+    }
+
+    // Read under the lock, so the file is not being replaced by another writer
+    writer_lock   lock(tasks_file);
+    std::string   content = read_file(tasks_file);
+    binary_header header  = read_binary_header(content);
+    char         *records = content.data() + sizeof(header);
+
+    // Files of an older version are upgraded by rewriting them instead
+    if (header.version != binary_header().version)
+    {
+        return false;
+    }
+
+    // Validate everything before modifying anything (priority takes a single index)
+    std::vector<index_range> ranges;
+    if (type == "priority")
+    {
+        std::size_t index = std::stoul(record.at(1));
+        ranges.push_back({ index, index + 1 });
+    }
+    else
+    {
+        ranges = get_index_ranges(std::vector(record.begin() + 1, record.end()));
+    }
+    if (!ranges.empty() && ranges.back().end > header.tasks_count)
+    {
+        throw std::out_of_range("Task index out of range");
+    }
+
+    std::uint64_t priority = type == "priority" ? std::stoul(record.at(2)) : 0;
+    std::uint8_t  done     = type == "done";
+
+    for (const index_range &range : ranges)
+    {
+        for (std::size_t index = range.begin; index < range.end; index++)
+        {
+            char *patched = records + index * sizeof(binary_record);
+            if (type == "priority")
+                std::memcpy(patched + offsetof(binary_record, priority), &priority, sizeof(priority));
+            else
+                std::memcpy(patched + offsetof(binary_record, done), &done, sizeof(done));
+        }
+    }
+
+    // The order index goes first, as it is checked against the version, which
+    // only changes once the file is replaced
+    std::uint64_t version = lock.get_version();
+    patch_order_index(record, version, header.generation);
+
+    std::string temporary = get_temporary_filename(tasks_file);
+    write_file_synced(temporary, content, false);
+    std::filesystem::rename(temporary, tasks_file);
+    lock.set_version(version + 1);
+    return true;
+}
+
+/// Apply a journal record to the tag index, keeping the posting lists sorted.
+/// @return False if the record shifts the task indices, requiring a rebuild.
+bool apply_record_to_tag_index(tag_index &index, const std::vector<std::string> &record)
+{
+    const std::string &type = record.at(0);
+
+    if (type == "add")
+    {
+        index.tasks_count++;
+    }
+    else if (type == "remove" || type == "auto-remove")
+    {
+        return false;
+    }
+    else if (type == "tags-add" || type == "tags-remove")
+    {
+        std::size_t task_index = std::stoul(record.at(1));
+        for (const std::string &tag : record | std::views::drop(2))
+        {
+            std::vector<std::size_t> &postings = index.postings[tag];
+
+            auto position = std::ranges::lower_bound(postings, task_index);
+            bool present  = position != postings.end() && *position == task_index;
+
+            if (type == "tags-add" && !present) postings.insert(position, task_index);
+            if (type == "tags-remove" && present) postings.erase(position);
+            if (postings.empty()) index.postings.erase(tag);
+        }
+    }
+
+    return true;
+}
+
+/// Apply a modification to the tasks and queue it to be appended to the
+/// journal by `commit_tasks`.
+/// @note Modifications that do not change the layout of a binary tasks file
+/// are patched into its records, unless the tasks were already loaded.
+void journal(std::vector<std::string> record)
+{
+    if (!store.loaded && is_binary_tasks_file(tasks_file) && patch_binary_tasks(record))
+    {
+        return;
+    }
+
+    apply_record(load_tasks(), record);
+
+    // A loaded index is kept across the commands of a server, so it has to
+    // follow the tasks (or be built again from them)
+    if (store.tags_index.loaded && !apply_record_to_tag_index(store.tags_index, record))
+    {
+        store.tags_index = {};
+    }
+    if (store.orders_index.loaded && !apply_record_to_order_index(store.orders_index, record))
+    {
+        store.orders_index = {};
+    }
+
+    store.pending.emplace_back(std::move(record));
+}
+
+/// Build the tag index from the loaded tasks.
+void build_tag_index()
+{
+    tag_index &index = store.tags_index;
+    index.postings.clear();
+    index.tasks_count = store.tasks.size();
+
+    // Collect the postings by tag ID, then name them once per tag
+    std::vector<std::vector<std::size_t>> postings(get_tags_count());
+    for (std::size_t i = 0; i < store.tasks.size(); i++)
+    {
+        for (std::uint32_t tag : store.tasks[i].tags)
+        {
+            postings[tag].emplace_back(i); // Sorted, as indices are increasing
+        }
+    }
+    for (std::uint32_t tag = 0; tag < postings.size(); tag++)
+    {
+        if (!postings[tag].empty())
+        {
+            index.postings.emplace(get_tag_name(tag), std::move(postings[tag]));
+        }
+    }
+
+    index.snapshot     = store.binary ? read_binary_generation(tasks_file) : store.snapshot_hash;
+    index.journal_size = store.binary ? 0 : store.journal_size;
+    index.loaded       = true;
+}
+
+/// Write the tag index, replacing it atomically.
+///
+/// The first line is the header
+/// `tags;<tasks count>;<snapshot hash or generation>;<journal size>`, followed
+/// by a line for each tag `<count>;<semicolon-separated indices>;<tag>`.
+void write_tag_index()
+{
+    const tag_index &index = store.tags_index;
+
+    std::string content = std::format("tags;{};{};{}\n", index.tasks_count, index.snapshot, index.journal_size);
+    for (const auto &[tag, postings] : index.postings)
+    {
+        content += std::to_string(postings.size());
+        for (std::size_t task_index : postings)
+        {
+            content += ";" + std::to_string(task_index);
+        }
+        content += ";" + escape_field(tag) + "\n";
+    }
+
+    std::string temporary = get_temporary_filename(tasks_file + ".tags");
+    write_file_synced(temporary, content, false);
+    std::filesystem::rename(temporary, tasks_file + ".tags");
+}
+
+/// Read the tag index written by `write_tag_index`.
+/// @return False if there is no valid tag index.
+bool read_tag_index()
+{
+    tag_index &index = store.tags_index;
+
+    mapped_file      file(tasks_file + ".tags");
+    std::string_view content = file.content();
+    if (content.empty())
+    {
+        return false;
+    }
+
+    std::string_view header = next_line(content);
+    if (std::ranges::count(header, ';') != 3 || next_field(header) != "tags")
+    {
+        return false;
+    }
+
+    // A malformed index (torn or edited by hand) is rebuilt by the caller
+    try
+    {
+        index.tasks_count  = parse_number<std::size_t>(next_field(header));
+        index.snapshot     = parse_number<std::uint64_t>(next_field(header));
+        index.journal_size = parse_number<std::size_t>(next_field(header));
+
+        while (!content.empty())
+        {
+            std::string_view line  = next_line(content);
+            std::size_t      count = parse_number<std::size_t>(next_field(line));
+            if (count > index.tasks_count)
+            {
+                return false;
+            }
+
+            std::vector<std::size_t> postings;
+            postings.reserve(count);
+            for (std::size_t j = 0; j < count; j++)
+            {
+                postings.emplace_back(parse_number<std::size_t>(next_field(line)));
+                if (postings.back() >= index.tasks_count)
+                {
+                    return false;
+                }
+            }
+
+            index.postings.emplace(unescape_field(line), std::move(postings)); // Rest of the line is the tag
+        }
+    }
+    catch (const std::runtime_error &)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+/// Obtain the tag index, reading it (and catching it up with the journal) or
+/// rebuilding it from the tasks.
+tag_index &load_tag_index()
+{
+    tag_index &index = store.tags_index;
+    if (index.loaded)
+    {
+        return index;
+    }
+
+    // Modifications not yet written are only reflected by the tasks in memory
+    if (!store.pending.empty())
+    {
+        build_tag_index();
+        return index;
+    }
+
+    bool binary = is_binary_tasks_file(tasks_file);
+    bool valid  = read_tag_index();
+
+    if (valid && binary)
+    {
+        valid = std::filesystem::exists(tasks_file) && index.snapshot == read_binary_generation(tasks_file);
+    }
+    else if (valid)
+    {
+        load_tasks();
+        valid = index.snapshot == store.snapshot_hash && index.journal_size <= store.journal_size;
+
+        // Catch up with the journal records written after the index
+        if (valid && index.journal_size < store.journal_size)
+        {
+            mapped_file      journal(tasks_file + ".journal");
+            std::string_view records = journal.content().substr(index.journal_size, store.journal_size - index.journal_size);
+
+            while (valid && !records.empty())
+            {
+                valid = apply_record_to_tag_index(index, split_fields(next_line(records)));
+            }
+
+            index.journal_size = store.journal_size;
+            if (valid) write_tag_index();
+        }
+    }
+
+    if (!valid)
+    {
+        index = {};
+        load_tasks();
+        build_tag_index();
+        write_tag_index();
+    }
+
+    index.loaded = true;
+    return index;
+}
+
+/// Rebuild the tag index after the tasks file was rewritten, if there is one.
+void rebuild_tag_index()
+{
+    if (store.tags_index.loaded || std::filesystem::exists(tasks_file + ".tags"))
+    {
+        build_tag_index();
+        write_tag_index();
+    }
+}
+
+/// Mark the loaded tag index as reflecting the journal once the pending
+/// modifications, which `journal` applied to it, are appended to it.
+void publish_tag_index()
+{
+    if (store.tags_index.loaded)
+    {
+        store.tags_index.journal_size = store.journal_size;
+    }
+}
+
+/// Find the indices of the tasks that have any of the tags, using the tag
+/// index.
+/// @return Sorted indices.
+std::vector<std::size_t> find_tagged_tasks(const std::unordered_set<std::string> &tags)
+{
+    const tag_index &index = load_tag_index();
+
+    // Union of the posting lists
+    std::vector<std::size_t> matches;
+    for (const std::string &tag : tags)
+    {
+        if (auto postings = index.postings.find(tag); postings != index.postings.end())
+        {
+            matches.insert(matches.end(), postings->second.begin(), postings->second.end());
+        }
+    }
+
+    parallel_sort(matches, matches.size(), std::less {});
+    matches.erase(std::ranges::unique(matches).begin(), matches.end());
+    return matches;
+}
+
+/// Find the indices of the tasks whose text or any of the tags match any of
+/// the globs. The tags are matched through the tag index, once per distinct
+/// tag, and the texts of a binary tasks file are read without loading the
+/// tasks.
+/// @return Sorted indices.
+std::vector<std::size_t> find_glob_matching_tasks(const std::vector<std::string> &patterns)
+{
+    std::vector<compiled_glob> globs = patterns | std::views::transform(compile_glob) | std::ranges::to<std::vector>();
+
+    const tag_index  &index = load_tag_index();
+    std::vector<char> matched(index.tasks_count); // Not `std::vector<bool>`, written from multiple threads
+
+    for (const auto &[tag, postings] : index.postings)
+    {
+        if (any_glob_matches(globs, tag))
+        {
+            for (std::size_t task_index : postings) matched[task_index] = true;
+        }
+    }
+
+    if (!store.loaded && is_binary_tasks_file(tasks_file) && std::filesystem::exists(tasks_file))
+    {
+        mapped_file      file(tasks_file);
+        std::string_view content = file.content();
+
+        // Only the texts column is read
+        binary_tasks columns(content);
+        matched.resize(columns.tasks_count);
+        parallel_for(columns.tasks_count, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t j = begin; j < end; j++)
+            {
+                matched[j] = matched[j] || any_glob_matches(globs, columns.texts.at(j));
+            }
+        });
+    }
+    else
+    {
+        const std::vector<task> &tasks = load_tasks();
+        matched.resize(tasks.size());
+        parallel_for(tasks.size(), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t j = begin; j < end; j++)
+            {
+                matched[j] = matched[j] || any_glob_matches(globs, tasks[j].text);
+            }
+        });
+    }
+
+    std::vector<std::size_t> matches;
+    for (std::size_t j = 0; j < matched.size(); j++)
+    {
+        if (matched[j]) matches.emplace_back(j);
+    }
+    return matches;
+}
+
+/// Obtain the tasks at the indices, without loading the other tasks where
+/// possible (binary tasks file).
+/// @param columns Columns to read from the binary tasks file, the tasks may
+///                have the other columns empty.
+std::vector<task> get_tasks_at(const std::vector<std::size_t> &indices, task_columns columns = {})
+{
+    if (!store.loaded && is_binary_tasks_file(tasks_file) && std::filesystem::exists(tasks_file))
+    {
+        mapped_file file(tasks_file);
+        return parse_binary_tasks(file.content(), &indices, columns);
+    }
+
+    const std::vector<task> &tasks = load_tasks();
+    std::vector<task>        result(indices.size());
+    parallel_for(indices.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t j = begin; j < end; j++)
+        {
+            result[j] = tasks.at(indices[j]);
+        }
+    });
+    return result;
+}
+
+/// Obtain the number of tasks, reading only the header of the binary tasks
+/// file where possible.
+std::size_t get_tasks_count()
+{
+    if (!store.loaded && is_binary_tasks_file(tasks_file) && std::filesystem::exists(tasks_file))
+    {
+        mapped_file file(tasks_file);
+        return read_binary_header(file.content()).tasks_count;
+    }
+
+    return load_tasks().size();
+}
+
+/// Expand the ranges of task indices, checking each range against the number
+/// of tasks first, so that a huge range fails instead of exhausting memory.
+std::vector<std::size_t> get_task_indices(const optrone::number_list &numbers)
+{
+    std::size_t              tasks_count = get_tasks_count();
+    std::vector<std::size_t> indices;
+    for (const optrone::number_list::range &range : numbers.ranges)
+    {
+        if (range.last >= tasks_count)
+        {
+            throw std::out_of_range("Task index out of range");
+        }
+
+        for (std::uint64_t index = range.first; index <= range.last; index++)
+        {
+            indices.emplace_back(index);
+        }
+    }
+    return indices;
+}
+
+/// Obtain all the tasks, reading only the columns from the binary tasks file
+/// where possible.
+/// @param buffer Receives the tasks read from the binary tasks file.
+/// @return The loaded tasks, or the buffer.
+const std::vector<task> &get_all_tasks(std::vector<task> &buffer, task_columns columns)
+{
+    if (!store.loaded && is_binary_tasks_file(tasks_file) && std::filesystem::exists(tasks_file))
+    {
+        mapped_file file(tasks_file);
+        buffer = parse_binary_tasks(file.content(), nullptr, columns);
+        return buffer;
+    }
+
+    return load_tasks();
+}
+
+/// Lowercase an ASCII letter, so that the searches ignore the case.
+unsigned char fold_case(char character)
+{
+    return character >= 'A' && character <= 'Z' ? character - 'A' + 'a' : character;
+}
+
+/// Call `function(trigram)` for each trigram of the text (with repeats).
+template <typename function_type>
+void for_each_trigram(std::string_view text, function_type function)
+{
+    std::uint32_t trigram = 0;
+    for (std::size_t j = 0; j < text.size(); j++)
+    {
+        trigram = (trigram << 8 | fold_case(text[j])) & 0xFFFFFF;
+        if (j >= 2) function(trigram);
+    }
+}
+
+/// Add the trigrams of the text to the postings of the task, keeping the
+/// posting lists sorted.
+void add_trigrams(std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> &postings, std::uint32_t task_index, std::string_view text)
+{
+    for_each_trigram(text, [&](std::uint32_t trigram) {
+        std::vector<std::uint32_t> &list = postings[trigram];
+        if (list.empty() || list.back() < task_index)
+        {
+            list.emplace_back(task_index); // Common case, tasks are indexed in order
+            return;
+        }
+
+        auto position = std::ranges::lower_bound(list, task_index);
+        if (*position != task_index) list.insert(position, task_index);
+    });
+}
+
+/// Apply a journal record to the search index, only ever adding postings.
+/// @return False if the record shifts the task indices (or refers to tasks the
+/// index does not cover), requiring a rebuild.
+bool apply_record_to_search_index(search_index &index, const std::vector<std::string> &record)
+{
+    const std::string &type = record.at(0);
+
+    if (type == "add")
+    {
+        add_trigrams(index.postings, index.tasks_count++, record.at(1));
+    }
+    else if (type == "remove" || type == "auto-remove")
+    {
+        return false;
+    }
+    else if (type == "text" || type == "notes-add")
+    {
+        std::size_t task_index = std::stoul(record.at(1));
+        if (task_index >= index.tasks_count)
+        {
+            return false;
+        }
+
+        for (const std::string &text : record | std::views::drop(2))
+        {
+            add_trigrams(index.postings, task_index, text);
+        }
+    }
+
+    return true;
+}
+
+/// Build the search index from the loaded tasks. The tasks are indexed in
+/// parallel chunks, and the postings of the chunks are concatenated in order.
+void build_search_index()
+{
+    search_index            &index = store.trigrams_index;
+    const std::vector<task> &tasks = store.tasks;
+    if (tasks.size() > std::numeric_limits<std::uint32_t>::max())
+    {
+        throw std::runtime_error("Too many tasks to index");
+    }
+
+    using postings_map = std::unordered_map<std::uint32_t, std::vector<std::uint32_t>>;
+
+    std::vector<std::size_t>  bounds = split_into_chunks(tasks.size());
+    std::vector<postings_map> chunks(bounds.size() - 1);
+    run_in_parallel(chunks.size(), [&](std::size_t c) {
+        for (std::size_t i = bounds[c]; i < bounds[c + 1]; i++)
+        {
+            add_trigrams(chunks[c], i, tasks[i].text);
+            for (const std::string &note : tasks[i].notes)
+            {
+                add_trigrams(chunks[c], i, note);
+            }
+        }
+    });
+
+    index.postings = std::move(chunks[0]);
+    for (std::size_t c = 1; c < chunks.size(); c++)
+    {
+        for (auto &[trigram, list] : chunks[c])
+        {
+            std::vector<std::uint32_t> &postings = index.postings[trigram];
+            postings.insert(postings.end(), list.begin(), list.end());
+        }
+    }
+
+    index.tasks_count  = tasks.size();
+    index.snapshot     = store.binary ? read_binary_generation(tasks_file) : store.snapshot_hash;
+    index.journal_size = store.binary ? 0 : store.journal_size;
+    index.loaded       = true;
+}
+
+/// Write the search index, replacing it atomically.
+void write_search_index()
+{
+    const search_index &index = store.trigrams_index;
+
+    search_index_header header = {
+        .tasks_count    = index.tasks_count,
+        .trigrams_count = index.postings.size(),
+        .snapshot       = index.snapshot,
+        .journal_size   = index.journal_size,
+    };
+
+    std::vector<search_index_entry> entries;
+    entries.reserve(index.postings.size());
+    for (const auto &[trigram, list] : index.postings)
+    {
+        entries.push_back({ .trigram = trigram, .count = static_cast<std::uint32_t>(list.size()) });
+    }
+    std::ranges::sort(entries, {}, &search_index_entry::trigram);
+
+    // Encode the differences of the consecutive indices in LEB128
+    std::string lists;
+    for (search_index_entry &entry : entries)
+    {
+        entry.offset = lists.size();
+
+        std::uint32_t previous = 0;
+        for (std::uint32_t task_index : index.postings.at(entry.trigram))
+        {
+            std::uint32_t delta = task_index - previous;
+            for (; delta >= 0x80; delta >>= 7)
+            {
+                lists += static_cast<char>(delta | 0x80);
+            }
+            lists    += static_cast<char>(delta);
+            previous  = task_index;
+        }
+    }
+
+    std::string content;
+    content.reserve(sizeof(header) + entries.size() * sizeof(search_index_entry) + lists.size());
+    content.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    content.append(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(search_index_entry));
+    content.append(lists);
+
+    std::string temporary = get_temporary_filename(tasks_file + ".search");
+    write_file_synced(temporary, content, false);
+    std::filesystem::rename(temporary, tasks_file + ".search");
+}
+
+/// Read the header of the search index written by `write_search_index` and
+/// validate the layout.
+/// @return False if the content is not a valid search index.
+bool read_search_index_header(std::string_view content, search_index_header &header)
+{
+    if (content.size() < sizeof(header))
+    {
+        return false;
+    }
+
+    std::memcpy(&header, content.data(), sizeof(header));
+    return std::string_view(header.magic, sizeof(header.magic)) == std::string_view(search_index_header().magic, sizeof(header.magic)) &&
+           header.trigrams_count <= (content.size() - sizeof(header)) / sizeof(search_index_entry);
+}
+
+/// Decode a posting list of the search index.
+/// @param lists The posting lists following the entries.
+std::vector<std::uint32_t> decode_search_postings(std::string_view lists, const search_index_entry &entry)
+{
+    if (entry.offset > lists.size())
+    {
+        throw std::runtime_error("Invalid search index");
+    }
+
+    std::vector<std::uint32_t> postings(entry.count);
+    std::size_t                pos      = entry.offset;
+    std::uint32_t              previous = 0;
+    for (std::uint32_t &task_index : postings)
+    {
+        std::uint32_t delta = 0;
+        for (int shift = 0;; shift += 7)
+        {
+            if (pos == lists.size() || shift > 28)
+            {
+                throw std::runtime_error("Invalid search index");
+            }
+
+            unsigned char byte  = lists[pos++];
+            delta              |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+            if (byte < 0x80) break;
+        }
+        task_index = previous += delta;
+    }
+    return postings;
+}
+
+/// Read the whole search index written by `write_search_index`.
+/// @return False if there is no valid search index.
+bool read_search_index()
+{
+    search_index &index = store.trigrams_index;
+
+    mapped_file         file(tasks_file + ".search");
+    search_index_header header;
+    if (!read_search_index_header(file.content(), header))
+    {
+        return false;
+    }
+
+    std::string_view entries = file.content().substr(sizeof(header), header.trigrams_count * sizeof(search_index_entry));
+    std::string_view lists   = file.content().substr(sizeof(header) + entries.size());
+
+    index.postings.clear();
+    for (std::size_t j = 0; j < header.trigrams_count; j++)
+    {
+        search_index_entry entry;
+        std::memcpy(&entry, entries.data() + j * sizeof(entry), sizeof(entry));
+        index.postings.emplace(entry.trigram, decode_search_postings(lists, entry));
+    }
+
+    index.tasks_count  = header.tasks_count;
+    index.snapshot     = header.snapshot;
+    index.journal_size = header.journal_size;
+    return true;
+}
+
+/// Make sure the persisted search index is up to date, catching it up with the
+/// journal or rebuilding it from the tasks if needed. An index that is already
+/// up to date is left on disk, for the searches to read only the posting lists
+/// they need.
+void update_search_index()
+{
+    search_index &index = store.trigrams_index;
+    if (index.loaded)
+    {
+        return;
+    }
+
+    // Modifications not yet written are only reflected by the tasks in memory
+    // (the index is dropped after the search, as it does not match the file)
+    if (!store.pending.empty())
+    {
+        build_search_index();
+        return;
+    }
+
+    bool                binary = is_binary_tasks_file(tasks_file);
+    search_index_header header;
+    bool                valid = read_search_index_header(mapped_file(tasks_file + ".search").content(), header);
+
+    if (valid && binary)
+    {
+        valid = std::filesystem::exists(tasks_file) && header.snapshot == read_binary_generation(tasks_file);
+        if (valid) return;
+    }
+    else if (valid)
+    {
+        load_tasks();
+        valid = header.snapshot == store.snapshot_hash && header.journal_size <= store.journal_size;
+        if (valid && header.journal_size == store.journal_size) return;
+
+        // Catch up with the journal records written after the index
+        if (valid && read_search_index())
+        {
+            mapped_file      journal(tasks_file + ".journal");
+            std::string_view records = journal.content().substr(index.journal_size, store.journal_size - index.journal_size);
+
+            while (valid && !records.empty())
+            {
+                valid = apply_record_to_search_index(index, split_fields(next_line(records)));
+            }
+
+            index.journal_size = store.journal_size;
+            index.loaded       = valid;
+            if (valid) write_search_index();
+        }
+    }
+
+    if (!valid || !index.loaded)
+    {
+        index = {};
+        load_tasks();
+        build_search_index();
+        write_search_index();
+    }
+}
+
+/// Apply the pending modifications to the search index once they are written,
+/// if the index is loaded, or for the binary format, if there is one.
+/// Otherwise, the index is caught up with the journal on the next search.
+/// @param previous_generation Generation of the binary tasks file before it
+/// was rewritten (binary format only).
+/// @note Called under the writer lock, so the index is the one of the tasks the
+/// modifications were made on.
+void publish_search_index(std::uint64_t previous_generation = 0)
+{
+    search_index &index = store.trigrams_index;
+    if (!index.loaded && (!store.binary || !std::filesystem::exists(tasks_file + ".search")))
+    {
+        return;
+    }
+
+    bool valid = index.loaded || (read_search_index() && index.snapshot == previous_generation);
+    for (std::size_t j = 0; valid && j < store.pending.size(); j++)
+    {
+        valid = apply_record_to_search_index(index, store.pending[j]);
+    }
+
+    if (valid)
+    {
+        index.snapshot     = store.binary ? read_binary_generation(tasks_file) : store.snapshot_hash;
+        index.journal_size = store.binary ? 0 : store.journal_size;
+    }
+    else
+    {
+        build_search_index();
+    }
+
+    index.loaded = true;
+    write_search_index();
+}
+
+/// Rebuild the search index after the tasks file was rewritten, if there is
+/// one.
+void rebuild_search_index()
+{
+    if (store.trigrams_index.loaded || std::filesystem::exists(tasks_file + ".search"))
+    {
+        build_search_index();
+        write_search_index();
+    }
+}
+
+/// Find the indices of the tasks that may contain the query in their text or
+/// notes, by intersecting the posting lists of the trigrams of the query.
+/// @return Sorted indices, or all the tasks if the query has no trigrams.
+std::vector<std::size_t> find_search_candidates(std::string_view query)
+{
+    update_search_index();
+
+    std::vector<std::uint32_t> trigrams;
+    for_each_trigram(query, [&](std::uint32_t trigram) { trigrams.emplace_back(trigram); });
+    std::ranges::sort(trigrams);
+    trigrams.erase(std::ranges::unique(trigrams).begin(), trigrams.end());
+
+    // Obtain the posting lists from memory, or only the needed ones from disk
+    const search_index                     &index = store.trigrams_index;
+    std::vector<std::vector<std::uint32_t>> lists;
+    mapped_file                             file(index.loaded ? std::string() : tasks_file + ".search");
+    search_index_header                     header;
+    if (!index.loaded && !read_search_index_header(file.content(), header))
+    {
+        throw std::runtime_error("Invalid search index");
+    }
+
+    std::size_t tasks_count = index.loaded ? index.tasks_count : header.tasks_count;
+    for (std::uint32_t trigram : trigrams)
+    {
+        if (index.loaded)
+        {
+            auto it = index.postings.find(trigram);
+            lists.emplace_back(it != index.postings.end() ? it->second : std::vector<std::uint32_t>());
+            continue;
+        }
+
+        std::string_view entries  = file.content().substr(sizeof(header), header.trigrams_count * sizeof(search_index_entry));
+        std::string_view postings = file.content().substr(sizeof(header) + entries.size());
+
+        auto entry_at = [&](std::size_t j) {
+            search_index_entry entry;
+            std::memcpy(&entry, entries.data() + j * sizeof(entry), sizeof(entry));
+            return entry;
+        };
+
+        // Binary search the entries, sorted by the trigram
+        std::size_t low = 0, high = header.trigrams_count;
+        while (low < high)
+        {
+            std::size_t middle = (low + high) / 2;
+            if (entry_at(middle).trigram < trigram)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+
+        bool exists = low < header.trigrams_count && entry_at(low).trigram == trigram;
+        lists.emplace_back(exists ? decode_search_postings(postings, entry_at(low)) : std::vector<std::uint32_t>());
+    }
+
+    // Do not keep an index built over the modifications not yet written
+    if (!store.pending.empty())
+    {
+        store.trigrams_index = {};
+    }
+
+    if (lists.empty())
+    {
+        std::vector<std::size_t> all(tasks_count);
+        std::iota(all.begin(), all.end(), 0);
+        return all;
+    }
+
+    // Intersect from the shortest list, so the intermediate results stay small
+    std::ranges::sort(lists, {}, &std::vector<std::uint32_t>::size);
+    std::vector<std::uint32_t> candidates = std::move(lists[0]);
+    for (std::size_t l = 1; l < lists.size() && !candidates.empty(); l++)
+    {
+        std::vector<std::uint32_t> intersection;
+        std::ranges::set_intersection(candidates, lists[l], std::back_inserter(intersection));
+        candidates = std::move(intersection);
+    }
+
+    return std::vector<std::size_t>(candidates.begin(), candidates.end());
+}
+
+/// Check if the text contains the query, ignoring the case of ASCII letters.
+bool contains_folded(std::string_view text, std::string_view query)
+{
+    auto equal = [](char a, char b) { return fold_case(a) == fold_case(b); };
+    return !std::ranges::search(text, query, equal).empty() || query.empty();
+}
+
+/// Compact the journal by writing all the tasks as a new snapshot.
+void compact_tasks()
+{
+    std::string snapshot = format_tasks(store.tasks);
+
+    // Replace the snapshot atomically, the old journal becomes stale along with it
+    std::string temporary = get_temporary_filename(tasks_file);
+    write_file_synced(temporary, snapshot, false);
+    std::filesystem::rename(temporary, tasks_file);
+
+    std::error_code error;
+    std::filesystem::remove(tasks_file + ".journal", error);
+
+    store.snapshot_hash = hash_content(snapshot);
+    store.journal_size  = 0;
+    store.compact       = false;
+
+    rebuild_tag_index();
+    rebuild_order_index();
+    rebuild_search_index();
+}
+
+/// Load the tasks again, and apply the pending modifications over them.
+void reload_tasks()
+{
+    std::vector<std::vector<std::string>> pending = std::move(store.pending);
+
+    store = {};
+    for (const std::vector<std::string> &record : pending)
+    {
+        apply_record(load_tasks(), record);
+    }
+    store.pending = std::move(pending);
+}
+
+/// Append the pending modifications to the journal, compacting it if it grows
+/// past the threshold. The binary tasks file is rewritten instead.
+void publish_tasks()
+{
+    if (store.binary)
+    {
+        std::uint64_t previous_generation = read_binary_generation(tasks_file);
+
+        write_binary_tasks();
+        rebuild_tag_index();
+        rebuild_order_index();
+        publish_search_index(previous_generation);
+    }
+    else if (store.compact)
+    {
+        compact_tasks();
+    }
+    else
+    {
+        // Start a new journal if there is none (or it is stale)
+        std::string data;
+        if (store.journal_size == 0)
+        {
+            data = std::format("journal;{}\n", store.snapshot_hash);
+        }
+
+        for (const std::vector<std::string> &record : store.pending)
+        {
+            data += join_fields(record) + "\n";
+        }
+
+        write_file_synced(tasks_file + ".journal", data, store.journal_size != 0);
+        store.journal_size += data.size();
+        publish_tag_index();
+        publish_order_index();
+        publish_search_index();
+
+        if (store.journal_size > journal_compaction_threshold)
+        {
+            compact_tasks();
+        }
+    }
+}
+
+/// Write the pending modifications, if the tasks file is still the version
+/// they were made on. Otherwise, another writer committed in between, so make
+/// them again over its tasks and retry.
+/// @return False if they could not be written, and are still pending.
+bool try_commit_tasks()
+{
+    if (store.pending.empty())
+    {
+        return true;
+    }
+
+    try
+    {
+        for (std::size_t attempt = 1;; attempt++)
+        {
+            {
+                writer_lock lock(tasks_file);
+                if (lock.get_version() == store.version)
+                {
+                    // The indices rebuilt while publishing reflect the new version
+                    store.version++;
+                    publish_tasks();
+                    lock.set_version(store.version);
+                    break;
+                }
+            }
+
+            if (attempt == commit_attempts_max)
+            {
+                throw std::runtime_error("Too many conflicting writers");
+            }
+            reload_tasks();
+        }
+
+        store.pending.clear();
+    }
+    catch (const std::exception &error)
+    {
+        std::println("Failed to save the tasks to `{}`: {}", tasks_file, error.what());
+        return false;
+    }
+
+    return true;
+}
+
+/// Write the pending modifications.
+void commit_tasks()
+{
+    try_commit_tasks();
+}
+
+// Sorting
+
+/// Order of the listed tasks or notes.
+enum class sort_order {
+    index,      ///< By index.
+    priority,   ///< By priority, highest first.
+    completion, ///< Done first.
+    ascending,  ///< By the first character of the text, ascending.
+    descending, ///< By the first character of the text, descending.
+    notes,      ///< By the number of notes, most first.
+    tags,       ///< By the number of tags, most first.
+};
+
+/// Compute the key of a text for the text-ordering modes, so that it is not
+/// inspected again in every comparison. Empty text sorts first.
+std::int64_t get_text_sort_key(std::string_view text, sort_order order)
+{
+    std::int64_t key = text.empty() ? -1 : static_cast<unsigned char>(text[0]);
+    return order == sort_order::descending ? -key : key;
+}
+
+/// Compute the key of a task for the sort order, where smaller keys come
+/// first.
+std::int64_t get_sort_key(const task &task, sort_order order)
+{
+    switch (order)
+    {
+        case sort_order::index:      return 0;
+        case sort_order::priority:   return -static_cast<std::int64_t>(task.priority);
+        case sort_order::completion: return task.done ? 0 : 1;
+        case sort_order::ascending:
+        case sort_order::descending: return get_text_sort_key(task.text, order);
+        case sort_order::notes:      return -static_cast<std::int64_t>(task.notes.size());
+        case sort_order::tags:       return -static_cast<std::int64_t>(task.tags.size());
+    }
+    return 0;
+}
+
+/// Sort the positions `0..keys.size()` by their keys, breaking ties by the
+/// position, and keep only `limit` of them after skipping the first `offset`.
+///
+/// Only the positions are moved around, never the tasks or the notes, and with
+/// a limit, only the top `offset + limit` positions are sorted (partial sort).
+/// As ties are broken by the position, the order is the same for any number of
+/// jobs.
+std::vector<std::size_t> sort_positions(const std::vector<std::int64_t> &keys, std::size_t offset, std::size_t limit)
+{
+    std::vector<std::size_t> positions(keys.size());
+    std::iota(positions.begin(), positions.end(), 0);
+
+    offset          = std::min(offset, positions.size());
+    std::size_t end = offset + std::min(limit, positions.size() - offset);
 
-// list --sort
-auto list_sort_option = std::make_shared<optrone::option_template>(optrone::option_template{
-    .description = "Sort tasks in specific order (index, priority, completion, ascending, descending, notes, tags)",
-    .short_names = { 's' },
-    .long_names  = { "sort" },
-    .params      = { "key" },
-    .defaults    = { "priority" },
-});
+    parallel_sort(positions, end, [&](std::size_t a, std::size_t b) { return std::pair(keys[a], a) < std::pair(keys[b], b); });
 
-// list
-auto list_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description    = "List task(s) from the tasks list.",
-    .names          = { "list" },
-    .nested_options = { list_include_notes_option, list_filter_option, list_sort_option },
-});
+    positions.erase(positions.begin(), positions.begin() + offset);
+    return positions;
+}
 
-// done
-auto done_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description = "Mark task(s) as done.",
-    .names       = { "done" },
-    .params      = { "task index" },
-    .variadic    = true,
-});
+/// Find the indices of the tasks in the order (priority or completion) using
+/// the order index, keeping only `limit` of them after skipping the first
+/// `offset`. Only the listed part of the order is read, nothing is sorted.
+std::vector<std::size_t> find_ordered_tasks(sort_order order, std::size_t offset, std::size_t limit)
+{
+    const order_index &index = load_order_index();
 
-// undo
-auto undo_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description = "Unmark task(s) as done.",
-    .names       = { "undo" },
-    .params      = { "task index" },
-    .variadic    = true,
-});
+    std::vector<std::size_t> indices;
+    auto                     append = [&](const std::vector<std::uint64_t> &ordered) {
+        std::size_t begin = std::min(offset, ordered.size());
+        std::size_t count = std::min(limit - indices.size(), ordered.size() - begin);
+        indices.insert(indices.end(), ordered.begin() + begin, ordered.begin() + begin + count);
+        offset -= begin;
+    };
 
-// edit text
-auto edit_text_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description = "Edit task's text.",
-    .names       = { "text" },
-    .params      = { "task index", "text" },
-});
+    if (order == sort_order::priority)
+    {
+        append(index.by_priority);
+        return indices;
+    }
 
-// edit priority
-auto edit_priority_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description = "Edit task's priority.",
-    .names       = { "priority" },
-    .params      = { "task index", "priority" },
-    .defaults    = { "0" }, // Zero priority if none provided
-});
+    // Done tasks first, then the pending tasks (the rest), each by index
+    append(index.done_tasks);
 
-// edit
-auto edit_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description        = "Edit the task.",
-    .names              = { "edit" },
-    .nested_subcommands = { edit_text_subcommand, edit_priority_subcommand },
-});
+    auto done = index.done_tasks.begin();
+    for (std::size_t task_index = 0; task_index < index.priorities.size() && indices.size() < limit; task_index++)
+    {
+        if (done != index.done_tasks.end() && *done == task_index)
+            done++;
+        else if (offset > 0)
+            offset--;
+        else
+            indices.emplace_back(task_index);
+    }
+    return indices;
+}
 
-// notes add
-auto notes_add_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description = "Add note(s) to the task.",
-    .names       = { "add" },
-    .params      = { "task index", "notes" },
-    .variadic    = true,
-});
+// Output
 
-// notes remove
-auto notes_remove_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description = "Remove note(s) from the task.",
-    .names       = { "remove" },
-    .params      = { "task index", "note index" },
-    .variadic    = true,
-});
+/// Buffered writer for the listings, which may print millions of lines.
+///
+/// The lines are formatted into one reusable buffer, which is written to the
+/// standard output in large chunks, so the memory used stays bounded however
+/// long the listing is.
+struct listing_writer {
+    static constexpr std::size_t flush_threshold = 64 * 1024; ///< Write the buffer once it grows past this size.
 
-// notes list --sort
-auto notes_list_sort_option = std::make_shared<optrone::option_template>(optrone::option_template{
-    .description = "Sort notes in specific order (index, ascending, descending)",
-    .short_names = { 's' },
-    .long_names  = { "sort" },
-    .params      = { "key" },
-    .defaults    = { "ascending" },
-});
+    std::string buffer; ///< Formatted output not yet written.
 
-// notes list
-auto notes_list_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description    = "List notes from the task(s).",
-    .names          = { "list" },
-    .params         = { "task index" },
-    .variadic       = true,
-    .nested_options = { notes_list_sort_option },
-});
+    listing_writer()
+    {
+        buffer.reserve(flush_threshold * 2);
+    }
 
-// notes
-auto notes_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description        = "Edit notes of the task",
-    .names              = { "notes" },
-    .nested_subcommands = { notes_add_subcommand, notes_remove_subcommand, notes_list_subcommand }
-});
+    ~listing_writer()
+    {
+        flush();
+    }
 
-// tags add
-auto tags_add_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description = "Add tag(s) to the task.",
-    .names       = { "add" },
-    .params      = { "task index", "tags" },
-    .variadic    = true,
-});
+    listing_writer(const listing_writer &)            = delete;
+    listing_writer &operator=(const listing_writer &) = delete;
 
-// tags remove
-auto tags_remove_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description = "Remove tag(s) from the task.",
-    .names       = { "remove" },
-    .params      = { "task index", "tags" },
-    .variadic    = true,
-});
+    /// Format the text without a newline.
+    template <typename... format_args>
+    void print(std::format_string<format_args...> format, format_args &&...args)
+    {
+        std::format_to(std::back_inserter(buffer), format, std::forward<format_args>(args)...);
+    }
 
-// tags list
-auto tags_list_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description = "List tags from the task(s).",
-    .names       = { "list" },
-    .params      = { "task index" },
-    .variadic    = true,
-});
+    /// Append the text as is, without formatting.
+    void write(std::string_view text)
+    {
+        buffer += text;
+    }
 
-// tags
-auto tags_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
-    .description        = "Edit tags of the task",
-    .names              = { "tags" },
-    .nested_subcommands = { tags_add_subcommand, tags_remove_subcommand, tags_list_subcommand }
-});
+    /// End the line, and write the buffer if it grew large enough.
+    void end_line()
+    {
+        buffer += '\n';
 
-// Templates
+        if (buffer.size() >= flush_threshold)
+        {
+            flush();
+        }
+    }
 
-std::vector options = {
-    help_option,
-    version_option,
-    file_option,
-};
+    /// Format a line.
+    template <typename... format_args>
+    void println(std::format_string<format_args...> format, format_args &&...args)
+    {
+        print(format, std::forward<format_args>(args)...);
+        end_line();
+    }
 
-std::vector subcommands = {
-    add_subcommand,
-    remove_subcommand,
-    auto_remove_subcommand,
-    list_subcommand,
-    done_subcommand,
-    undo_subcommand,
-    edit_subcommand,
-    notes_subcommand,
-    tags_subcommand
+    /// Write the buffer to the standard output.
+    void flush()
+    {
+        std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+        buffer.clear();
+    }
 };
 
-// Globals
+/// Write the line of a task in the listings, `<index>. [<x>] (P<priority>): <text> [<tag>]...`.
+void write_task_line(listing_writer &writer, std::size_t index, const task &task)
+{
+    writer.print("{}. [{}] (P{}): {} ", index, task.done ? "x" : " ", task.priority, task.text);
+    for (std::uint32_t tag : task.tags)
+    {
+        writer.write("[");
+        writer.write(get_tag_name(tag));
+        writer.write("]");
+    }
+    writer.end_line();
+}
+
+/// Parse a sort order for the option, among the allowed ones.
+sort_order parse_sort_order(const std::string &sorter, std::string_view option, std::initializer_list<std::pair<std::string_view, sort_order>> allowed)
+{
+    for (const auto &[name, order] : allowed)
+    {
+        if (sorter == name)
+        {
+            return order;
+        }
+    }
 
-std::vector<task> tasks;
-std::string       tasks_file   = "tasks.txt";
-std::string       program_name = "./optrone_usage_example";
+    std::println("Invalid sorter for `{}`.", option);
+    std::println("Try `{} --help` for more information.", program_name);
+    exit_command(1);
+}
 
 // Subcommand-specific globals
 
-bool                                                                                                list_include_notes = false;
-std::unordered_set<std::string>                                                                     list_filter_tags;
-std::function<bool(const std::tuple<long, task> &a, const std::tuple<long, task> &b)>               list_sort_compare;
-std::function<bool(const std::tuple<long, std::string> &a, const std::tuple<long, std::string> &b)> notes_list_sort_compare;
+/// Options of the command being run, reset before each command when serving.
+struct command_options {
+    bool                            list_include_notes = false;
+    std::unordered_set<std::string> list_filter_tags;
+    std::vector<std::string>        list_filter_globs;
+    sort_order                      list_sort         = sort_order::index;
+    std::size_t                     list_limit        = std::numeric_limits<std::size_t>::max();
+    std::size_t                     list_offset       = 0;
+    sort_order                      notes_list_sort   = sort_order::index;
+    std::size_t                     notes_list_limit  = std::numeric_limits<std::size_t>::max();
+    std::size_t                     notes_list_offset = 0;
+    std::size_t                     tags_list_limit   = std::numeric_limits<std::size_t>::max();
+    std::size_t                     tags_list_offset  = 0;
+    std::size_t                     search_limit      = std::numeric_limits<std::size_t>::max();
+};
+
+command_options command;
 
 // Handlers
 
@@ -409,7 +3657,7 @@ void handle_help_option(const std::vector<optrone::parsed_argument> &args, std::
     const optrone::parsed_argument &arg = args[i++];
 
     std::print("{}", optrone::format_saec(optrone::get_help_message(options, subcommands)));
-    std::exit(0);
+    exit_command(0);
 }
 
 void handle_version_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
@@ -420,148 +3668,274 @@ void handle_version_option(const std::vector<optrone::parsed_argument> &args, st
     std::println("Version 1.0.0");
     std::println("Copyright (c) 2025 Anstro Pleuton.");
     std::println("This project is licensed under the terms of MIT License.");
-    std::exit(0);
+    exit_command(0);
 }
 
 void handle_file_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    tasks_file = arg.values[0];
+    // While serving, the paths are absolute so that they name the same file
+    // regardless of the working directory of the client
+    std::string file = serving ? std::filesystem::absolute(arg.values[0]).string() : arg.values[0];
+    if (file == tasks_file)
+    {
+        return; // Keep the loaded tasks
+    }
+
+    // Checkpoint the previous file before switching to a new one
+    commit_tasks();
+    store      = {};
+    tasks_file = std::move(file);
+}
+
+void handle_jobs_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
+{
+    const optrone::parsed_argument &arg = args[i++];
+
+    jobs_count = std::max<std::size_t>(std::stoul(arg.values[0]), 1);
 }
 
 void handle_add_subcommand(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    tasks = read_tasks(tasks_file);
-    write_tasks(tasks, tasks_file + ".bak");
-    tasks.emplace_back(arg.values[0]);
-    write_tasks(tasks, tasks_file);
+    journal({ "add", arg.values[0] });
 }
 
 void handle_remove_subcommand(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    tasks = read_tasks(tasks_file);
-    write_tasks(tasks, tasks_file + ".bak");
-    tasks = filter_out(tasks, get_indices(arg.values));
-    write_tasks(tasks, tasks_file);
+    std::vector<index_range> ranges   = get_index_ranges(arg.numbers);
+    bool                     selected = !ranges.empty();
+
+    // Check for nested options
+    while (i < args.size())
+    {
+        const optrone::parsed_argument &next_arg = args[i];
+
+        if (auto option = next_arg.ref_option.lock(); option == remove_glob_option)
+        {
+            i++;
+            selected = true;
+
+            // Select the consecutive matching tasks as ranges of indices
+            std::vector<std::size_t> matched = find_glob_matching_tasks(next_arg.values);
+            for (std::size_t j = 0, k = 0; j < matched.size(); j = k)
+            {
+                k = j + 1;
+                while (k < matched.size() && matched[k] == matched[k - 1] + 1)
+                {
+                    k++;
+                }
+                ranges.push_back({ .begin = matched[j], .end = matched[k - 1] + 1 });
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (!selected)
+    {
+        std::println("Expected task indices or `--glob` for `remove`.");
+        std::println("Try `{} --help` for more information.", program_name);
+        exit_command(1);
+    }
+
+    if (!ranges.empty())
+    {
+        journal(make_record("remove", format_index_ranges(merge_index_ranges(std::move(ranges)))));
+    }
 }
 
 void handle_auto_remove_subcommand(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    tasks = read_tasks(tasks_file);
-    write_tasks(tasks, tasks_file + ".bak");
-    tasks = tasks | std::views::filter([](const task &task) { return !task.done; }) | std::ranges::to<std::vector>();
-    write_tasks(tasks, tasks_file);
+    journal({ "auto-remove" });
 }
 
 void handle_list_filter_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    list_filter_tags = std::unordered_set(arg.values.begin(), arg.values.end());
+    command.list_filter_tags = std::unordered_set(arg.values.begin(), arg.values.end());
+}
+
+void handle_list_glob_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
+{
+    const optrone::parsed_argument &arg = args[i++];
+
+    command.list_filter_globs = arg.values;
 }
 
 void handle_list_include_notes_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    list_include_notes = true;
+    command.list_include_notes = true;
 }
 
 void handle_list_sort_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    std::string sorter = arg.values[0];
+    command.list_sort = parse_sort_order(arg.values[0], "list --sort", {
+        { "index",      sort_order::index      },
+        { "priority",   sort_order::priority   },
+        { "completion", sort_order::completion },
+        { "ascending",  sort_order::ascending  },
+        { "descending", sort_order::descending },
+        { "notes",      sort_order::notes      },
+        { "tags",       sort_order::tags       },
+    });
+}
+
+void handle_list_limit_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
+{
+    const optrone::parsed_argument &arg = args[i++];
+
+    command.list_limit = std::stoul(arg.values[0]);
+}
+
+void handle_list_offset_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
+{
+    const optrone::parsed_argument &arg = args[i++];
+
+    command.list_offset = std::stoul(arg.values[0]);
+}
+
+void handle_list_subcommand(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
+{
+    const optrone::parsed_argument &arg = args[i++];
 
-    if (sorter == "index")
+    // Check for nested options
+    while (i < args.size())
     {
-        // Do nothing
+        const optrone::parsed_argument &next_arg = args[i];
+
+        if (auto option = next_arg.ref_option.lock(); option == list_filter_option)
+        {
+            handle_list_filter_option(args, i);
+        }
+        else if (option == list_glob_option)
+        {
+            handle_list_glob_option(args, i);
+        }
+        else if (option == list_include_notes_option)
+        {
+            handle_list_include_notes_option(args, i);
+        }
+        else if (option == list_sort_option)
+        {
+            handle_list_sort_option(args, i);
+        }
+        else if (option == list_limit_option)
+        {
+            handle_list_limit_option(args, i);
+        }
+        else if (option == list_offset_option)
+        {
+            handle_list_offset_option(args, i);
+        }
+        else
+        {
+            break;
+        }
     }
-    else if (sorter == "priority")
+
+    // Filter tasks by tags (through the tag index) and globs; the listed
+    // tasks are referred to by position, and the tasks are never copied. The
+    // notes are read only if they are listed or sorted by
+    bool                     filtered = !command.list_filter_tags.empty() || !command.list_filter_globs.empty();
+    bool                     ordered  = !filtered && (command.list_sort == sort_order::priority || command.list_sort == sort_order::completion);
+    task_columns             columns  = { .notes = command.list_include_notes || command.list_sort == sort_order::notes };
+    std::vector<std::size_t> indices; // Task index of each position
+    std::vector<task>        matched;
+    if (ordered)
     {
-        list_sort_compare = [](const auto &a, const auto &b) {
-            auto [index_a, task_a] = a;
-            auto [index_b, task_b] = b;
-            return task_a.priority > task_b.priority;
-        };
+        // Read the listed tasks in order from the order index, without sorting
+        indices = find_ordered_tasks(command.list_sort, command.list_offset, command.list_limit);
+        matched = get_tasks_at(indices, columns);
     }
-    else if (sorter == "completion")
+    if (!command.list_filter_tags.empty())
     {
-        list_sort_compare = [](const auto &a, const auto &b) {
-            auto [index_a, task_a] = a;
-            auto [index_b, task_b] = b;
-            return task_a.done > task_b.done;
-        };
+        indices = find_tagged_tasks(command.list_filter_tags);
     }
-    else if (sorter == "ascending")
+    if (!command.list_filter_globs.empty())
     {
-        list_sort_compare = [](const auto &a, const auto &b) {
-            auto [index_a, task_a] = a;
-            auto [index_b, task_b] = b;
-            return !task_a.text.empty() && !task_b.text.empty() && task_a.text[0] < task_b.text[0];
-        };
+        std::vector<std::size_t> tagged = std::move(indices);
+        std::vector<std::size_t> globbed = find_glob_matching_tasks(command.list_filter_globs);
+
+        indices.clear();
+        std::ranges::set_union(tagged, globbed, std::back_inserter(indices));
     }
-    else if (sorter == "descending")
+    if (filtered)
     {
-        list_sort_compare = [](const auto &a, const auto &b) {
-            auto [index_a, task_a] = a;
-            auto [index_b, task_b] = b;
-            return !task_a.text.empty() && !task_b.text.empty() && task_a.text[0] > task_b.text[0];
-        };
+        matched = get_tasks_at(indices, columns);
     }
-    else if (sorter == "notes")
+
+    const std::vector<task> &list_tasks = filtered || ordered ? matched : get_all_tasks(matched, columns);
+    if (!filtered && !ordered)
     {
-        list_sort_compare = [](const auto &a, const auto &b) {
-            auto [index_a, task_a] = a;
-            auto [index_b, task_b] = b;
-            return task_a.notes.size() > task_b.notes.size();
-        };
+        indices.resize(list_tasks.size());
+        std::iota(indices.begin(), indices.end(), 0);
     }
-    else if (sorter == "tags")
+
+    // Sort the tasks by the precomputed keys (positions are in index order)
+    std::vector<std::int64_t> keys(list_tasks.size());
+    if (command.list_sort != sort_order::index && !ordered)
     {
-        list_sort_compare = [](const auto &a, const auto &b) {
-            auto [index_a, task_a] = a;
-            auto [index_b, task_b] = b;
-            return task_a.tags.size() > task_b.tags.size();
-        };
+        parallel_for(list_tasks.size(), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t j = begin; j < end; j++)
+            {
+                keys[j] = get_sort_key(list_tasks[j], command.list_sort);
+            }
+        });
     }
-    else
+
+    // Print the tasks
+    listing_writer writer;
+    std::size_t    offset = ordered ? 0 : command.list_offset; // Already skipped by the order index
+    for (std::size_t position : sort_positions(keys, offset, command.list_limit))
     {
-        std::println("Invalid sorter for `list --sort`.");
-        std::println("Try `{} --help` for more information.", program_name);
-        std::exit(1);
+        std::size_t index = indices[position];
+        const task &task  = list_tasks[position];
+
+        write_task_line(writer, index, task);
+
+        if (command.list_include_notes)
+        {
+            for (const std::string &note : task.notes)
+            {
+                writer.println("  -> {}", note);
+            }
+        }
     }
 }
 
-void handle_list_subcommand(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
+void handle_search_limit_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    bool include_notes = false;
+    command.search_limit = std::stoul(arg.values[0]);
+}
+
+void handle_search_subcommand(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
+{
+    const optrone::parsed_argument &arg = args[i++];
 
     // Check for nested options
     while (i < args.size())
     {
         const optrone::parsed_argument &next_arg = args[i];
 
-        if (auto option = next_arg.ref_option.lock(); option == list_filter_option)
-        {
-            handle_list_filter_option(args, i);
-        }
-        else if (option == list_include_notes_option)
-        {
-            handle_list_include_notes_option(args, i);
-        }
-        else if (option == list_sort_option)
+        if (auto option = next_arg.ref_option.lock(); option == search_limit_option)
         {
-            handle_list_sort_option(args, i);
+            handle_search_limit_option(args, i);
         }
         else
         {
@@ -569,38 +3943,30 @@ void handle_list_subcommand(const std::vector<optrone::parsed_argument> &args, s
         }
     }
 
-    // Filter tasks by tags
-
-    // clang-format off
-    auto list_tasks = read_tasks(tasks_file)
-        | std::views::enumerate
-        | std::views::filter([&](const auto &pair) { auto [_, task] = pair; return list_filter_tags.empty() || has_any_intersection(task.tags, list_filter_tags); })
-        | std::ranges::to<std::vector>();
-    // clang-format on
-
-    // Sort the tasks
-    if (list_sort_compare)
-    {
-        std::ranges::sort(list_tasks, list_sort_compare);
-    }
-
-    // Print the tasks
-    for (const auto &tuple : list_tasks)
+    // Check the candidates of the trigram index against the tasks, in chunks
+    // so that only the tasks up to the limit are read
+    const std::string       &query      = arg.values[0];
+    std::vector<std::size_t> candidates = find_search_candidates(query);
+    std::size_t              found      = 0;
+    listing_writer           writer;
+    for (std::size_t begin = 0; begin < candidates.size() && found < command.search_limit; begin += parallel_min_chunk)
     {
-        auto [index, task] = tuple;
+        std::vector<std::size_t> indices(candidates.begin() + begin, candidates.begin() + std::min(begin + parallel_min_chunk, candidates.size()));
+        std::vector<task>        tasks = get_tasks_at(indices);
 
-        // clang-format off
-        std::println("{}. [{}] (P{}): {} {}", index, task.done ? "x" : " ", task.priority, task.text,
-                     std::views::transform(task.tags, [](const std::string &str) { return "[" + str + "]"; })
-                     | std::views::join
-                     | std::ranges::to<std::string>());
-        // clang-format on
-
-        if (include_notes)
+        for (std::size_t j = 0; j < tasks.size() && found < command.search_limit; j++)
         {
-            for (const std::string &note : task.notes)
+            auto matches = [&](const std::string &text) { return contains_folded(text, query); };
+            if (!matches(tasks[j].text) && std::ranges::none_of(tasks[j].notes, matches))
+            {
+                continue; // Trigrams are common to the query, but not the whole query
+            }
+
+            found++;
+            write_task_line(writer, indices[j], tasks[j]);
+            for (const std::string &note : tasks[j].notes | std::views::filter(matches))
             {
-                std::println("  -> {}", note);
+                writer.println("  -> {}", note);
             }
         }
     }
@@ -610,54 +3976,28 @@ void handle_done_subcommand(const std::vector<optrone::parsed_argument> &args, s
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    for (const std::string &value : arg.values)
-    {
-        std::size_t index = std::stoul(value);
-
-        tasks = read_tasks(tasks_file);
-        write_tasks(tasks, tasks_file + ".bak");
-        tasks.at(index).done = true;
-        write_tasks(tasks, tasks_file);
-    }
+    journal(make_record("done", format_index_ranges(get_index_ranges(arg.numbers))));
 }
 
 void handle_undo_subcommand(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    for (const std::string &value : arg.values)
-    {
-        std::size_t index = std::stoul(value);
-
-        tasks = read_tasks(tasks_file);
-        write_tasks(tasks, tasks_file + ".bak");
-        tasks.at(index).done = false;
-        write_tasks(tasks, tasks_file);
-    }
+    journal(make_record("undo", format_index_ranges(get_index_ranges(arg.numbers))));
 }
 
 void handle_edit_text_subcommand(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    std::size_t index = std::stoul(arg.values[0]);
-
-    tasks = read_tasks(tasks_file);
-    write_tasks(tasks, tasks_file + ".bak");
-    tasks.at(index).text = arg.values[1];
-    write_tasks(tasks, tasks_file);
+    journal({ "text", arg.values[0], arg.values[1] });
 }
 
 void handle_edit_priority_subcommand(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    std::size_t index = std::stoul(arg.values[0]);
-
-    tasks = read_tasks(tasks_file);
-    write_tasks(tasks, tasks_file + ".bak");
-    tasks.at(index).priority = std::stoul(arg.values[1]);
-    write_tasks(tasks, tasks_file);
+    journal({ "priority", arg.values[0], arg.values[1] });
 }
 
 void handle_edit_subcommand(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
@@ -669,7 +4009,7 @@ void handle_edit_subcommand(const std::vector<optrone::parsed_argument> &args, s
         std::println("Missing subcommand for `edit`.");
         std::println("Usage: {} edit <subcommand> [arg]...", program_name);
         std::println("Try `{} --help` for more information.", program_name);
-        std::exit(1);
+        exit_command(1);
     }
 
     const optrone::parsed_argument &arg = args[i]; // Don't skip subcommand
@@ -688,53 +4028,39 @@ void handle_notes_add_subcommand(const std::vector<optrone::parsed_argument> &ar
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    std::size_t index = std::stoul(arg.values[0]);
-
-    tasks = read_tasks(tasks_file);
-    write_tasks(tasks, tasks_file + ".bak");
-    tasks.at(index).notes.insert(tasks.at(index).notes.end(), arg.values.begin() + 1, arg.values.end());
-    write_tasks(tasks, tasks_file);
+    journal(make_record("notes-add", arg.values));
 }
 
 void handle_notes_remove_subcommand(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    std::size_t task_index   = std::stoul(arg.values[0]);
-    auto        note_indices = get_indices(std::vector(arg.values.begin() + 1, arg.values.end())); // Exclude first value (task index)
-
-    tasks = read_tasks(tasks_file);
-    write_tasks(tasks, tasks_file + ".bak");
-    tasks.at(task_index).notes = filter_out(tasks.at(task_index).notes, note_indices);
-    write_tasks(tasks, tasks_file);
+    journal(make_record("notes-remove", arg.values));
 }
 
 void handle_notes_list_sort_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    std::string sorter = arg.values[0];
+    command.notes_list_sort = parse_sort_order(arg.values[0], "notes list --sort", {
+        { "index",      sort_order::index      },
+        { "ascending",  sort_order::ascending  },
+        { "descending", sort_order::descending },
+    });
+}
 
-    if (sorter == "index")
-        ; // Do nothing
-    else if (sorter == "ascending")
-        notes_list_sort_compare = [](const auto &a, const auto &b) {
-            auto [index_a, string_a] = a;
-            auto [index_b, string_b] = b;
-            return !string_a.empty() && !string_b.empty() && string_a[0] < string_b[0];
-        };
-    else if (sorter == "descending")
-        notes_list_sort_compare = [](const auto &a, const auto &b) {
-            auto [index_a, string_a] = a;
-            auto [index_b, string_b] = b;
-            return !string_a.empty() && !string_b.empty() && string_a[0] > string_b[0];
-        };
-    else
-    {
-        std::println("Invalid sorter for `notes list --sort`.");
-        std::println("Try `{} --help` for more information.", program_name);
-        std::exit(1);
-    }
+void handle_notes_list_limit_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
+{
+    const optrone::parsed_argument &arg = args[i++];
+
+    command.notes_list_limit = std::stoul(arg.values[0]);
+}
+
+void handle_notes_list_offset_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
+{
+    const optrone::parsed_argument &arg = args[i++];
+
+    command.notes_list_offset = std::stoul(arg.values[0]);
 }
 
 void handle_notes_list_subcommand(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
@@ -750,31 +4076,42 @@ void handle_notes_list_subcommand(const std::vector<optrone::parsed_argument> &a
         {
             handle_notes_list_sort_option(args, i);
         }
+        else if (option == notes_list_limit_option)
+        {
+            handle_notes_list_limit_option(args, i);
+        }
+        else if (option == notes_list_offset_option)
+        {
+            handle_notes_list_offset_option(args, i);
+        }
         else
         {
             break;
         }
     }
 
-    // Print notes for each task indices provided
-    for (const std::string &value : arg.values)
+    // Print notes for each task indices provided (reading only those tasks,
+    // without their tags)
+    std::vector<std::size_t> indices = get_task_indices(arg.numbers);
+    std::vector<task>        tasks   = get_tasks_at(indices, { .tags = false });
+    listing_writer           writer;
+    for (std::size_t j = 0; j < indices.size(); j++)
     {
-        std::size_t task_index = std::stoul(value);
-        tasks                  = read_tasks(tasks_file);
-        auto list_notes        = tasks.at(task_index).notes | std::views::enumerate | std::ranges::to<std::vector>();
+        std::size_t                     task_index = indices[j];
+        const std::vector<std::string> &notes      = tasks[j].notes;
 
-        // Sort the notes
-        if (notes_list_sort_compare)
+        // Sort the notes by the precomputed keys
+        std::vector<std::int64_t> keys(notes.size());
+        if (command.notes_list_sort != sort_order::index)
         {
-            std::ranges::sort(list_notes, notes_list_sort_compare);
+            std::ranges::transform(notes, keys.begin(), [](const std::string &note) { return get_text_sort_key(note, command.notes_list_sort); });
         }
 
         // Print the notes list for each task
-        std::println("Task {}: {}", task_index, tasks.at(task_index).text);
-        for (const auto &tuple : list_notes)
+        writer.println("Task {}: {}", task_index, tasks[j].text);
+        for (std::size_t note_index : sort_positions(keys, command.notes_list_offset, command.notes_list_limit))
         {
-            auto [note_index, note] = tuple;
-            std::println("-> {}: {}", note_index, note);
+            writer.println("-> {}: {}", note_index, notes[note_index]);
         }
     }
 }
@@ -788,7 +4125,7 @@ void handle_notes_subcommand(const std::vector<optrone::parsed_argument> &args,
         std::println("Missing subcommand for `notes`.");
         std::println("Usage: {} notes <subcommand> [arg]...", program_name);
         std::println("Try `{} --help` for more information.", program_name);
-        std::exit(1);
+        exit_command(1);
     }
 
     const optrone::parsed_argument &arg = args[i]; // Don't skip subcommand
@@ -812,48 +4149,67 @@ void handle_tags_add_subcommand(const std::vector<optrone::parsed_argument> &arg
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    std::size_t index = std::stoul(arg.values[0]);
-
-    tasks = read_tasks(tasks_file);
-    write_tasks(tasks, tasks_file + ".bak");
-    tasks.at(index).tags.insert(arg.values.begin() + 1, arg.values.end());
-    write_tasks(tasks, tasks_file);
+    journal(make_record("tags-add", arg.values));
 }
 
 void handle_tags_remove_subcommand(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    std::size_t task_index = std::stoul(arg.values[0]);
+    journal(make_record("tags-remove", arg.values));
+}
 
-    // List of tags to remove
-    std::unordered_set tags_to_remove(arg.values.begin() + 1, arg.values.end()); // Exclude first value (task index)
+void handle_tags_list_limit_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
+{
+    const optrone::parsed_argument &arg = args[i++];
 
-    tasks = read_tasks(tasks_file);
-    write_tasks(tasks, tasks_file + ".bak");
+    command.tags_list_limit = std::stoul(arg.values[0]);
+}
 
-    // Construct new tags list by taking the set difference
-    std::unordered_set<std::string> new_tags;
-    std::ranges::set_difference(tasks.at(task_index).tags, tags_to_remove, std::inserter(new_tags, new_tags.begin()));
+void handle_tags_list_offset_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
+{
+    const optrone::parsed_argument &arg = args[i++];
 
-    // Assign new tags list back
-    tasks.at(task_index).tags = new_tags;
-    write_tasks(tasks, tasks_file);
+    command.tags_list_offset = std::stoul(arg.values[0]);
 }
 
 void handle_tags_list_subcommand(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
 {
     const optrone::parsed_argument &arg = args[i++];
 
-    for (const std::string &value : arg.values)
+    // Check for nested options
+    while (i < args.size())
+    {
+        const optrone::parsed_argument &next_arg = args[i];
+
+        if (auto option = next_arg.ref_option.lock(); option == tags_list_limit_option)
+        {
+            handle_tags_list_limit_option(args, i);
+        }
+        else if (option == tags_list_offset_option)
+        {
+            handle_tags_list_offset_option(args, i);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    // Read only the tasks at the indices, without their notes
+    std::vector<std::size_t> indices = get_task_indices(arg.numbers);
+    std::vector<task>        tasks   = get_tasks_at(indices, { .notes = false });
+    listing_writer           writer;
+    for (std::size_t j = 0; j < indices.size(); j++)
     {
-        std::size_t task_index = std::stoul(value);
-        tasks                  = read_tasks(tasks_file);
+        std::size_t task_index = indices[j];
 
-        std::println("Task {}: {}", task_index, tasks.at(task_index).text);
-        for (const std::string &tag : tasks.at(task_index).tags)
+        writer.println("Task {}: {}", task_index, tasks[j].text);
+        for (std::uint32_t tag : tasks[j].tags
+                                     | std::views::drop(command.tags_list_offset)
+                                     | std::views::take(command.tags_list_limit))
         {
-            std::println("-> {}", tag);
+            writer.println("-> {}", get_tag_name(tag));
         }
     }
 }
@@ -867,7 +4223,7 @@ void handle_tags_subcommand(const std::vector<optrone::parsed_argument> &args, s
         std::println("Missing subcommand for `tags`.");
         std::println("Usage: {} tags <subcommand> [arg]...", program_name);
         std::println("Try `{} --help` for more information.", program_name);
-        std::exit(1);
+        exit_command(1);
     }
 
     const optrone::parsed_argument &arg = args[i]; // Don't skip subcommand
@@ -887,15 +4243,413 @@ void handle_tags_subcommand(const std::vector<optrone::parsed_argument> &args, s
     }
 }
 
-/// Main function
-int main(int argc, char *argv[])
+// Serving
+
+/// Maximum number of commands whose modifications are written together.
+constexpr std::size_t group_commit_max = 64;
+
+/// Maximum number of arguments and size of each argument of a request.
+constexpr std::uint32_t request_arguments_max = 64 * 1024;
+constexpr std::uint32_t request_argument_max  = 16 * 1024 * 1024;
+
+/// Time given to a client to send its request, and to take each write of the
+/// output, before it is dropped so that a stalled client does not hold up the
+/// others.
+constexpr std::chrono::milliseconds client_timeout { 5000 };
+
+int run_command(const std::vector<std::string> &arguments);
+
+#if !defined(_WIN32)
+
+/// Set by the signal handler to stop serving.
+volatile std::sig_atomic_t stop_serving = 0;
+
+/// Whether the modifications of the commands waiting for the group commit
+/// were lost, so that their clients are told they failed.
+bool batch_dropped = false;
+
+/// Write all the data to the file descriptor.
+void write_all(int fd, std::string_view data)
+{
+    while (!data.empty())
+    {
+        ssize_t written = ::write(fd, data.data(), data.size());
+        if (written < 0 && errno == EINTR) continue;
+        if (written < 0) throw std::system_error(errno, std::generic_category(), "Failed to write to the socket");
+        data.remove_prefix(written);
+    }
+}
+
+/// Read exactly `size` bytes from the file descriptor, waiting for them until
+/// the deadline.
+/// @return False if the connection was closed or the deadline passed before.
+bool read_exact(int fd, char *data, std::size_t size, std::chrono::steady_clock::time_point deadline)
+{
+    while (size > 0)
+    {
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0)
+        {
+            return false;
+        }
+
+        pollfd readable { .fd = fd, .events = POLLIN };
+        int    ready = ::poll(&readable, 1, static_cast<int>(remaining.count()));
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0) return false;
+
+        ssize_t count = ::read(fd, data, size);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return false;
+        data += count;
+        size -= count;
+    }
+    return true;
+}
+
+/// Encode the arguments as a request: the number of arguments followed by
+/// each argument prefixed by its length, all lengths being 32-bit.
+std::string encode_request(const std::vector<std::string> &arguments)
+{
+    std::string request;
+    auto        append_length = [&](std::uint32_t length) { request.append(reinterpret_cast<const char *>(&length), sizeof(length)); };
+
+    append_length(arguments.size());
+    for (const std::string &argument : arguments)
+    {
+        append_length(argument.size());
+        request += argument;
+    }
+    return request;
+}
+
+/// Read a request encoded by `encode_request`, within `client_timeout`.
+/// @return False if the request is incomplete or malformed.
+bool read_request(int fd, std::vector<std::string> &arguments)
+{
+    auto deadline = std::chrono::steady_clock::now() + client_timeout;
+
+    std::uint32_t count = 0;
+    if (!read_exact(fd, reinterpret_cast<char *>(&count), sizeof(count), deadline) || count > request_arguments_max)
+    {
+        return false;
+    }
+
+    arguments.resize(count);
+    for (std::string &argument : arguments)
+    {
+        std::uint32_t length = 0;
+        if (!read_exact(fd, reinterpret_cast<char *>(&length), sizeof(length), deadline) || length > request_argument_max)
+        {
+            return false;
+        }
+
+        argument.resize(length);
+        if (!read_exact(fd, argument.data(), length, deadline))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Run the command of the client's request, as if it was run in the client's
+/// working directory, with the output sent to the client.
+/// @return Exit status of the command.
+int run_request(int client)
+{
+    // The first argument is the working directory of the client
+    std::vector<std::string> arguments;
+    if (!read_request(client, arguments) || arguments.empty())
+    {
+        return 1;
+    }
+    std::filesystem::path client_directory = arguments.front();
+    arguments.erase(arguments.begin());
+
+    // Send the standard output to the client for the duration of the command
+    std::fflush(stdout);
+    int output = ::dup(STDOUT_FILENO);
+    ::dup2(client, STDOUT_FILENO);
+
+    std::string           file      = tasks_file;
+    std::size_t           jobs      = jobs_count;
+    std::filesystem::path directory = std::filesystem::current_path();
+
+    // Drop the loaded tasks if another writer committed since
+    if (store.loaded && store.pending.empty() && read_tasks_version(tasks_file) != store.version)
+    {
+        store = {};
+    }
+
+    // The served tasks are set aside while the command uses another file
+    std::optional<task_store> served;
+    std::size_t               pending = store.pending.size();
+
+    int  status = 0;
+    bool thrown = false;
+    try
+    {
+        std::filesystem::current_path(client_directory);
+        tasks_file = std::filesystem::absolute(default_tasks_file).string();
+        if (tasks_file != file)
+        {
+            served = std::move(store);
+            store  = {};
+        }
+
+        command = {};
+        status  = run_command(arguments);
+    }
+    catch (const command_exit &exit)
+    {
+        status = exit.status;
+    }
+    catch (const std::exception &error)
+    {
+        std::println("Error: {}", error.what());
+        status = 1;
+        thrown = true;
+    }
+
+    if (tasks_file != file || served)
+    {
+        // Write the modifications to the other file and switch back to the
+        // served one (the modifications of a failed command are dropped)
+        if (status == 0 && !try_commit_tasks())
+        {
+            status = 1;
+        }
+        store      = served ? std::move(*served) : task_store {};
+        tasks_file = file;
+    }
+    else if (status != 0 && (thrown || store.pending.size() > pending))
+    {
+        // The client is told that the command failed, so none of its
+        // modifications are kept (a throw may have left a record half-applied)
+        try
+        {
+            store.pending.resize(pending);
+            reload_tasks();
+        }
+        catch (const std::exception &error)
+        {
+            std::println("Error: {}", error.what());
+            store         = {};
+            batch_dropped = true;
+        }
+    }
+    jobs_count = jobs;
+
+    std::error_code error;
+    std::filesystem::current_path(directory, error);
+
+    std::fflush(stdout);
+    ::dup2(output, STDOUT_FILENO);
+    ::close(output);
+
+    return status;
+}
+
+/// Serve the commands of the clients connecting to the Unix socket, until
+/// interrupted (SIGINT or SIGTERM).
+///
+/// The tasks stay loaded between commands. The commands are run one at a time,
+/// and the modifications of the commands arriving together are written to the
+/// journal at once (group commit), before any of their clients are answered.
+/// Each answer is the output of the command, followed by a zero byte and the
+/// exit status. A request starts with the working directory of the client, so
+/// that the paths (including the default tasks file) resolve as if the command
+/// was run by the client itself.
+void serve(const std::string &socket_path)
+{
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        throw std::runtime_error(std::format("Socket path `{}` is too long", socket_path));
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "Failed to create the socket");
+    }
+
+    // Replace a socket left behind by a previous server
+    if (std::filesystem::is_socket(socket_path))
+    {
+        std::filesystem::remove(socket_path);
+    }
+
+    if (::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || ::listen(listener, SOMAXCONN) < 0)
+    {
+        int error = errno;
+        ::close(listener);
+        throw std::system_error(error, std::generic_category(), std::format("Failed to listen on `{}`", socket_path));
+    }
+
+    // Interrupt the wait for the clients to stop, without restarting it
+    struct sigaction action {};
+    action.sa_handler = [](int) { stop_serving = 1; };
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN); // Clients may disconnect early
+
+    // The served file stays the same while the commands run in the working
+    // directories of their clients
+    tasks_file = std::filesystem::absolute(tasks_file).string();
+    serving    = true;
+
+    // Clients, the exit statuses of their commands and whether they left
+    // modifications for the group commit
+    std::vector<std::tuple<int, int, bool>> answering;
+    while (!stop_serving || !answering.empty())
+    {
+        // Keep taking the clients that are already waiting, then commit
+        pollfd incoming { .fd = listener, .events = POLLIN };
+        if (!stop_serving && answering.size() < group_commit_max && ::poll(&incoming, 1, answering.empty() ? -1 : 0) > 0)
+        {
+            if (int client = ::accept(listener, nullptr, nullptr); client >= 0)
+            {
+                // A client that does not take its output is dropped as well
+                timeval timeout { .tv_sec = client_timeout.count() / 1000, .tv_usec = client_timeout.count() % 1000 * 1000 };
+                ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+                std::size_t pending = store.pending.size();
+                int         status  = run_request(client);
+                answering.emplace_back(client, status, store.pending.size() > pending);
+            }
+            continue;
+        }
+
+        if (answering.empty())
+        {
+            continue; // Interrupted
+        }
+
+        // A batch that cannot be written is dropped, as its clients are told
+        // that their commands failed
+        bool committed = !batch_dropped && try_commit_tasks();
+        if (!committed)
+        {
+            store = {};
+        }
+        batch_dropped = false;
+
+        for (auto [client, status, modified] : answering)
+        {
+            char trailer[2] = { '\0', static_cast<char>(committed || !modified ? status : 1) };
+            try
+            {
+                write_all(client, std::string_view(trailer, sizeof(trailer)));
+            }
+            catch (const std::exception &)
+            {
+                // The client is gone, nothing to answer
+            }
+            ::close(client);
+        }
+        answering.clear();
+    }
+
+    serving = false;
+    ::close(listener);
+    std::filesystem::remove(socket_path);
+}
+
+/// Forward the arguments to the server listening on the Unix socket, and
+/// print its output.
+/// @return Exit status of the command run by the server.
+int forward_to_server(const std::string &socket_path, const std::vector<std::string> &arguments)
+{
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        std::println("Socket path `{}` is too long.", socket_path);
+        return 1;
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        std::println("Failed to connect to the server at `{}`: {}", socket_path, std::strerror(errno));
+        if (fd >= 0) ::close(fd);
+        return 1;
+    }
+
+    // The server runs the command in the working directory of the client
+    std::vector<std::string> request = { std::filesystem::current_path().string() };
+    request.insert(request.end(), arguments.begin(), arguments.end());
+    write_all(fd, encode_request(request));
+
+    // Print the output as it arrives, holding back what may be the trailer
+    std::string buffer;
+    char        chunk[64 * 1024];
+    ssize_t     count = 0;
+    while ((count = ::read(fd, chunk, sizeof(chunk))) > 0 || (count < 0 && errno == EINTR))
+    {
+        buffer.append(chunk, std::max<ssize_t>(count, 0));
+        if (buffer.size() > 2)
+        {
+            std::fwrite(buffer.data(), 1, buffer.size() - 2, stdout);
+            buffer.erase(0, buffer.size() - 2);
+        }
+    }
+    ::close(fd);
+
+    if (buffer.size() != 2 || buffer[0] != '\0')
+    {
+        std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+        std::println("Connection to the server was lost.");
+        return 1;
+    }
+
+    return static_cast<unsigned char>(buffer[1]);
+}
+
+#endif
+
+void handle_serve_option(const std::vector<optrone::parsed_argument> &args, std::size_t &i)
+{
+    const optrone::parsed_argument &arg = args[i++];
+
+    if (serving)
+    {
+        std::println("Already serving.");
+        exit_command(1);
+    }
+
+#if defined(_WIN32)
+    std::println("Serving is not supported on this platform.");
+    exit_command(1);
+#else
+    try
+    {
+        serve(arg.values[0]);
+    }
+    catch (const std::exception &error)
+    {
+        std::println("Failed to serve: {}", error.what());
+        exit_command(1);
+    }
+    exit_command(0);
+#endif
+}
+
+/// Parse the arguments and run the command.
+/// @return Exit status.
+int run_command(const std::vector<std::string> &arguments)
 {
     // Parsing
 
     std::vector<optrone::parsed_argument> args;
     try
     {
-        args = optrone::parse_arguments(std::vector<std::string>(argv + 1, argv + argc), options, subcommands);
+        args = optrone::parse_arguments(arguments, options, subcommands);
     }
     catch (const optrone::argument_error &error)
     {
@@ -910,8 +4664,6 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    if (argc >= 1) program_name = argv[0];
-
     if (args.empty())
     {
         std::println("Usage: {} [option]... <command> [arg]...", program_name);
@@ -936,6 +4688,14 @@ int main(int argc, char *argv[])
         {
             handle_file_option(args, i);
         }
+        else if (option == jobs_option)
+        {
+            handle_jobs_option(args, i);
+        }
+        else if (option == serve_option)
+        {
+            handle_serve_option(args, i);
+        }
 
         else if (auto subcommand = args[i].ref_subcommand.lock(); subcommand == add_subcommand)
         {
@@ -953,6 +4713,10 @@ int main(int argc, char *argv[])
         {
             handle_list_subcommand(args, i);
         }
+        else if (subcommand == search_subcommand)
+        {
+            handle_search_subcommand(args, i);
+        }
         else if (subcommand == done_subcommand)
         {
             handle_done_subcommand(args, i);
@@ -979,4 +4743,28 @@ int main(int argc, char *argv[])
             break;
         }
     }
+
+    return 0;
+}
+
+/// Main function
+int main(int argc, char *argv[])
+{
+    if (argc >= 1) program_name = argv[0];
+
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+
+#if !defined(_WIN32)
+    // Let the server run the command, unless starting the server
+    bool starting_server = std::ranges::any_of(arguments, [](std::string_view argument) { return argument.starts_with("--serve"); });
+    if (const char *socket_path = std::getenv("TASKMGR_SOCKET"); socket_path && !starting_server)
+    {
+        return forward_to_server(socket_path, arguments);
+    }
+#endif
+
+    // Write the tasks once, even if a handler exits early
+    std::atexit(commit_tasks);
+
+    return run_command(arguments);
 }
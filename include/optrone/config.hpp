@@ -0,0 +1,23 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This header file provides build configuration macros for Optrone, such as
+/// the ones used to compile Optrone as a header-only library.
+///
+/// This project is licensed under the terms of MIT License.
+
+#pragma once
+
+/// Marks the out-of-line definitions of Optrone's functions.
+///
+/// When `OPTRONE_HEADER_ONLY` is defined, the definitions are pasted into the
+/// generated single-header amalgamation (`optrone/optrone_single.hpp`) and
+/// must be `inline` to be included from multiple translation units. This lets
+/// the compiler inline and specialize Optrone's functions into the caller.
+#if defined(OPTRONE_HEADER_ONLY)
+    #define OPTRONE_INLINE inline
+#else
+    #define OPTRONE_INLINE
+#endif
@@ -0,0 +1,59 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This header file provides dialect policies that select, at compile time,
+/// which argument styles the tokenizer and the option matcher handle.
+///
+/// This project is licensed under the terms of MIT License.
+
+#pragma once
+
+namespace optrone {
+
+/// The default dialect, which handles both POSIX-style and Microsoft-style
+/// arguments, ignores case and splits both bundled short options and values.
+///
+/// A dialect is a policy type passed to `tokenize` and `parse_arguments` as a
+/// template argument. The parser is specialized for it, so the styles that a
+/// dialect turns off cost nothing. Custom dialects derive from one of the
+/// predefined ones and hide the members to change.
+///
+/// @note The compiled library provides only the predefined dialects (this,
+/// `posix_dialect` and `microsoft_dialect`). Custom dialects require the
+/// header-only mode (`OPTRONE_HEADER_ONLY`).
+struct default_dialect {
+    /// If true, `-s` and `--long` are options.
+    static constexpr bool posix_options = true;
+
+    /// If true, `/S` and `/LONG` are options (switches).
+    static constexpr bool microsoft_options = true;
+
+    /// If true, the names in the arguments must match the names in the
+    /// templates exactly, so only lowercase names are recognized. Otherwise,
+    /// the names are lowercased before matching.
+    static constexpr bool case_sensitive = false;
+
+    /// If true, `-abc` is split as `-a`, `-b` and `-c`. Otherwise, `-abc` is
+    /// matched as the long name `abc` (as with `/ABC`).
+    static constexpr bool bundling = true;
+
+    /// If true, `--long=value` and `/LONG:VALUE` are split into the option and
+    /// its value.
+    static constexpr bool value_splitting = true;
+};
+
+/// Dialect that handles only POSIX-style arguments, so that arguments starting
+/// with `/` (such as absolute paths) are regular arguments.
+struct posix_dialect : default_dialect {
+    static constexpr bool microsoft_options = false; ///< See `default_dialect`.
+};
+
+/// Dialect that handles only Microsoft-style arguments, so that arguments
+/// starting with `-` (such as negative numbers) are regular arguments.
+struct microsoft_dialect : default_dialect {
+    static constexpr bool posix_options = false; ///< See `default_dialect`.
+};
+
+} // namespace optrone
@@ -0,0 +1,44 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This header file provides file-backed parameter values, which refer to a
+/// file (`@path`) whose content is only mapped into memory when accessed.
+///
+/// This project is licensed under the terms of MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace optrone {
+
+/// State of the mapping of a file, shared by the copies of a `file_value`.
+/// The content is mapped read-only into memory on first access (read into
+/// memory where mapping is not available, i.e. on Windows), and unmapped when
+/// the last copy is gone.
+struct file_mapping {
+    std::once_flag              mapped;   ///< Whether the file is mapped.
+    std::shared_ptr<const char> data;     ///< Content of the file (null if it is empty), unmapped when released.
+    std::size_t                 size = 0; ///< Size of the file.
+};
+
+/// A file-backed parameter value (`@path`), whose content is the content of the
+/// file, mapped on first access.
+struct file_value {
+    std::string                   path;    ///< Path of the file.
+    std::shared_ptr<file_mapping> mapping; ///< Mapping of the file, shared by the copies (null if the value is not a file).
+
+    /// Obtain the content of the file, mapping it on the first call.
+    /// @throws std::system_error If the file cannot be opened or mapped (the
+    /// next call tries again).
+    /// @note The file must not be truncated while it is mapped.
+    std::string_view content() const;
+};
+
+} // namespace optrone
@@ -9,7 +9,10 @@
 
 #pragma once
 
+#include "optrone/config.hpp"   // IWYU pragma: export
+#include "optrone/dialect.hpp"  // IWYU pragma: export
 #include "optrone/error.hpp"    // IWYU pragma: export
+#include "optrone/file.hpp"     // IWYU pragma: export
 #include "optrone/help.hpp"     // IWYU pragma: export
 #include "optrone/parser.hpp"   // IWYU pragma: export
 #include "optrone/template.hpp" // IWYU pragma: export
@@ -10,11 +10,21 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "optrone/dialect.hpp"
 #include "optrone/error.hpp"
+#include "optrone/file.hpp"
 #include "optrone/template.hpp"
 
 namespace optrone {
@@ -34,18 +44,144 @@ struct token {
     text_range  range;                      ///< Range within the command line.
 };
 
+/// Unsigned integers of `param_kind::list` parameters.
+///
+/// The numbers are kept as the inclusive ranges they were given in (a single
+/// number is a range of one, and consecutive numbers are merged), so a range
+/// such as `0-1000000` costs as much as a single number. The ranges are only
+/// expanded when the values are first accessed.
+struct number_list {
+    /// Inclusive range of numbers.
+    struct range {
+        std::uint64_t first = 0; ///< First number in the range.
+        std::uint64_t last  = 0; ///< Last number in the range.
+    };
+
+    std::vector<range>                 ranges;              ///< Ranges of the numbers, in the order they were given in.
+    std::uint64_t                      count           = 0; ///< Number of numbers in the ranges (saturated at the maximum of `std::uint64_t`).
+    mutable std::vector<std::uint64_t> expanded;            ///< Numbers of the expanded ranges.
+    mutable std::size_t                expanded_ranges = 0; ///< Number of ranges expanded (not merged into anymore).
+
+    /// Append the inclusive range of numbers.
+    void append(std::uint64_t first, std::uint64_t last);
+
+    /// Obtain the numbers, expanding the ranges that were not yet expanded.
+    /// @note The span is invalidated by appending, and expanding is not
+    /// thread-safe.
+    /// @warning A range holds up to every `std::uint64_t`, and expanding it
+    /// can exhaust memory (`0-100000000000` is 800 GB). Check the ranges
+    /// against the expected bounds first, or iterate `ranges` instead.
+    std::span<const std::uint64_t> values() const;
+};
+
+/// Entries of `param_kind::map` parameters, from keys to values.
+///
+/// The keys and the values are stored back to back in a single string, and the
+/// entries (in the order of insertion) are found through a flat open-addressing
+/// table of their indices, so inserting an entry does not allocate per entry.
+/// An assigned value overwrites the old one when it fits, and is appended
+/// otherwise, with the string compacted once the old values outweigh the rest.
+struct string_map {
+    /// An entry, as the positions of its key and its value in the text.
+    struct entry {
+        std::size_t hash         = 0; ///< Hash of the key.
+        std::size_t key_begin    = 0; ///< Beginning of the key.
+        std::size_t key_length   = 0; ///< Length of the key.
+        std::size_t value_begin  = 0; ///< Beginning of the value.
+        std::size_t value_length = 0; ///< Length of the value.
+    };
+
+    std::string              text;            ///< Keys and values, back to back.
+    std::size_t              unused_size = 0; ///< Size of the old values in the text.
+    std::vector<entry>       map_entries;     ///< Entries in the order of insertion.
+    std::vector<std::size_t> slots;           ///< Index + 1 of the entry in each slot (0 if empty), the size is a power of two.
+
+    /// Insert the entry, or assign the value if the key is already in the map.
+    /// @return True if the entry is inserted, false if the value is assigned.
+    bool insert_or_assign(std::string_view key, std::string_view value);
+
+    /// Find the value of the key.
+    /// @note The views are invalidated by inserting.
+    std::optional<std::string_view> find(std::string_view key) const;
+
+    /// Check if the key is in the map.
+    bool contains(std::string_view key) const { return find(key).has_value(); }
+
+    /// Obtain the key and the value of the entry at the index (in the order of
+    /// insertion).
+    /// @note The views are invalidated by inserting.
+    std::pair<std::string_view, std::string_view> at(std::size_t index) const;
+
+    /// Obtain the keys and the values of all the entries (in the order of
+    /// insertion).
+    auto entries() const
+    {
+        return std::views::iota(0zu, size()) | std::views::transform([this](std::size_t index) { return at(index); });
+    }
+
+    /// Number of entries.
+    std::size_t size() const { return map_entries.size(); }
+
+    /// Check if there are no entries.
+    bool empty() const { return map_entries.empty(); }
+
+    /// Find the slot of the key, which is empty if the key is not in the map.
+    std::size_t find_slot(std::string_view key, std::size_t hash) const;
+
+    /// Copy the keys and the values in use into a new text, in order.
+    void compact();
+};
+
 /// Arguments parsed from command-line along with any parameters or default
 /// values.
 struct parsed_argument {
-    std::weak_ptr<option_template>     ref_option;        ///< Option associated with this argument.
-    std::weak_ptr<subcommand_template> ref_subcommand;    ///< Subcommand associated with this argument.
-    std::vector<std::string>           values;            ///< Values for parameters (including defaults).
+    std::weak_ptr<option_template>     ref_option {};     ///< Option associated with this argument.
+    std::weak_ptr<subcommand_template> ref_subcommand {}; ///< Subcommand associated with this argument.
+    std::vector<std::string>           values {};         ///< Values for parameters (including defaults), unless they are lists.
     bool                               is_global = false; ///< Whether the value is from a global parameter.
+    number_list                        numbers {};        ///< Numbers of all the values for `param_kind::list` parameters.
+    string_map                         entries {};        ///< Entries of all the values for `param_kind::map` parameters.
+
+    /// File of each `@path` value (without a mapping for the other values) for
+    /// parameters with `file_params`, empty for the other parameters.
+    std::vector<file_value> files {};
+
+    /// Obtain the value at the index, or the content of its file for a `@path`
+    /// value of parameters with `file_params` (mapped on the first access, and
+    /// valid as long as a copy of this argument is).
+    /// @throws std::out_of_range If the index is out of range.
+    /// @throws std::system_error If the file cannot be opened or mapped.
+    std::string_view value(std::size_t index) const;
 };
 
+/// Largest number of long names in a scope (the global options, the nested and
+/// inherited options of a subcommand, or the inherited options of an ancestor)
+/// that the parser scans linearly, the long names of larger scopes are hashed.
+/// The `option_lookup` benchmark calibrates it. It is atomic so that it can be
+/// changed while other threads parse, each parse reads it once per scope.
+extern std::atomic<std::size_t> linear_lookup_limit;
+
 /// Tokenize the arguments.
 std::vector<token> tokenize(const std::vector<std::string> &args);
 
+/// Tokenize the arguments in the dialect.
+/// @see default_dialect for the dialects.
+template <typename dialect>
+std::vector<token> tokenize(const std::vector<std::string> &args);
+
+/// Tokenize the arguments of `main` in place (without the program name, i.e.
+/// `argc - 1` and `argv + 1`).
+///
+/// When the arguments are back to back in memory, as the Linux kernel lays
+/// them out, they are scanned as a single block 8 bytes at a time, instead of
+/// measuring and searching each argument.
+std::vector<token> tokenize_argv(int argc, const char *const *argv);
+
+/// Tokenize the arguments of `main` in place in the dialect.
+/// @see tokenize_argv.
+template <typename dialect>
+std::vector<token> tokenize_argv(int argc, const char *const *argv);
+
 /// Reconstruct the command-line from tokens.
 std::string construct_command_line(const std::vector<token> &tokens);
 
@@ -76,4 +212,42 @@ std::vector<parsed_argument> parse_arguments(
     const std::vector<std::string>                    global_defaults = {},
     bool                                              global_variadic = false);
 
+/// Parse all the provided command-line arguments in the dialect.
+/// @see default_dialect for the dialects.
+/// @see parse_arguments for list of exceptions.
+template <typename dialect>
+std::vector<parsed_argument> parse_arguments(
+    const std::vector<std::string>                   &args,
+    std::vector<std::shared_ptr<option_template>>     options,
+    std::vector<std::shared_ptr<subcommand_template>> subcommands,
+    const std::vector<std::string>                    global_params   = {},
+    const std::vector<std::string>                    global_defaults = {},
+    bool                                              global_variadic = false);
+
+/// Parse the arguments of `main` (without the program name, i.e. `argc - 1`
+/// and `argv + 1`), tokenized in place.
+/// @see tokenize_argv.
+/// @see parse_arguments for list of exceptions.
+std::vector<parsed_argument> parse_argv(
+    int                                               argc,
+    const char *const                                *argv,
+    std::vector<std::shared_ptr<option_template>>     options,
+    std::vector<std::shared_ptr<subcommand_template>> subcommands,
+    const std::vector<std::string>                    global_params   = {},
+    const std::vector<std::string>                    global_defaults = {},
+    bool                                              global_variadic = false);
+
+/// Parse the arguments of `main`, tokenized in place, in the dialect.
+/// @see tokenize_argv.
+/// @see parse_arguments for list of exceptions.
+template <typename dialect>
+std::vector<parsed_argument> parse_argv(
+    int                                               argc,
+    const char *const                                *argv,
+    std::vector<std::shared_ptr<option_template>>     options,
+    std::vector<std::shared_ptr<subcommand_template>> subcommands,
+    const std::vector<std::string>                    global_params   = {},
+    const std::vector<std::string>                    global_defaults = {},
+    bool                                              global_variadic = false);
+
 } // namespace optrone
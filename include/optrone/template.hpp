@@ -17,6 +17,13 @@
 
 namespace optrone {
 
+/// Kind of values that the parameters of an option or a subcommand take.
+enum class param_kind {
+    string, ///< Values are kept as they are in `parsed_argument::values`.
+    list,   ///< Values are delimiter-separated lists of unsigned integers and inclusive ranges (e.g. `1,2,3` or `4-100,200`), converted into `parsed_argument::numbers`.
+    map     ///< Values are `key=value` entries, inserted into `parsed_argument::entries`. All occurrences of an option in a scope (the global scope for global options, the nested subcommand for the others) are merged into its first occurrence there.
+};
+
 /// A template for defining a command-line option.
 /// @note Certain features are "Mutually exclusive", meaning they cannot be used
 /// together. Those are:
@@ -48,6 +55,24 @@ struct option_template {
     /// parameter.
     /// @note This is a mutually-exclusive feature.
     bool variadic = false;
+
+    /// Kind of values that the parameters (including default values) take.
+    /// @note `param_kind::map` parameters cannot have default values.
+    param_kind params_kind = param_kind::string;
+
+    /// Delimiter between the elements of `param_kind::list` values.
+    /// @note Cannot be a digit or `-`.
+    char list_delimiter = ',';
+
+    /// If true, a key given more than once to `param_kind::map` parameters is
+    /// an error. Otherwise, the last value of the key is kept.
+    bool map_unique_keys = false;
+
+    /// If true, a value `@path` of `param_kind::string` parameters refers to a
+    /// file whose content is the value, mapped into memory only when accessed
+    /// through `parsed_argument::value` (so large inputs are never copied). A
+    /// value starting with `@@` is the literal value without the first `@`.
+    bool file_params = false;
 };
 
 /// A template for defining a command-line subcommand (the "positional argument").
@@ -78,10 +103,34 @@ struct subcommand_template {
     /// @note This is a mutually-exclusive feature.
     bool variadic = false;
 
+    /// Kind of values that the parameters (including default values) take.
+    /// @note `param_kind::map` parameters cannot have default values.
+    param_kind params_kind = param_kind::string;
+
+    /// Delimiter between the elements of `param_kind::list` values.
+    /// @note Cannot be a digit or `-`.
+    char list_delimiter = ',';
+
+    /// If true, a key given more than once to `param_kind::map` parameters is
+    /// an error. Otherwise, the last value of the key is kept.
+    bool map_unique_keys = false;
+
+    /// If true, a value `@path` of `param_kind::string` parameters refers to a
+    /// file whose content is the value, mapped into memory only when accessed
+    /// through `parsed_argument::value` (so large inputs are never copied). A
+    /// value starting with `@@` is the literal value without the first `@`.
+    bool file_params = false;
+
     /// Nested options for this subcommand.
     /// @note This is a mutually-exclusive feature.
     std::vector<std::shared_ptr<option_template>> nested_options;
 
+    /// Inherited options for this subcommand and all of its nested
+    /// subcommands (at any depth), declared once instead of in the nested
+    /// options of each. Options of the nearest subcommand take precedence, and
+    /// the nested options take precedence over the inherited options.
+    std::vector<std::shared_ptr<option_template>> inherited_options;
+
     /// Nested subcommands for this subcommand.
     std::vector<std::shared_ptr<subcommand_template>> nested_subcommands;
 };
@@ -0,0 +1,84 @@
+/// @file
+///
+/// @authors   Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This source provides implementation for file-backed parameter values.
+///
+/// This project is licensed under the terms of MIT License.
+
+#include <cerrno>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#if defined(_WIN32)
+    #include <fstream>
+    #include <iterator>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "optrone/config.hpp"
+#include "optrone/file.hpp"
+
+/// Map the file, throws if it cannot be opened or mapped.
+static void map_file(const std::string &path, optrone::file_mapping &mapping)
+{
+#if defined(_WIN32)
+    std::ifstream ifile(path, std::ios::binary);
+    if (!ifile)
+    {
+        throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), "Failed to open " + path);
+    }
+
+    auto buffer  = std::make_shared<std::string>(std::istreambuf_iterator<char>(ifile), std::istreambuf_iterator<char>());
+    mapping.data = std::shared_ptr<const char>(buffer, buffer->data());
+    mapping.size = buffer->size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "Failed to open " + path);
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0)
+    {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "Failed to stat " + path);
+    }
+
+    // Nothing to map in an empty file (mapping zero bytes fails)
+    if (status.st_size > 0)
+    {
+        void *address = ::mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED)
+        {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "Failed to map " + path);
+        }
+
+        std::size_t size  = status.st_size;
+        auto        unmap = [size](const char *data) { ::munmap(const_cast<char *>(data), size); };
+        mapping.data      = std::shared_ptr<const char>(static_cast<const char *>(address), unmap);
+        mapping.size      = size;
+    }
+
+    ::close(fd);
+#endif
+}
+
+OPTRONE_INLINE std::string_view optrone::file_value::content() const
+{
+    std::call_once(mapping->mapped, [this] { map_file(path, *mapping); });
+    return std::string_view(mapping->data.get(), mapping->size);
+}
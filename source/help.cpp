@@ -16,6 +16,7 @@
 #include <string_view>
 #include <vector>
 
+#include "optrone/config.hpp"
 #include "optrone/error.hpp"
 #include "optrone/help.hpp"
 #include "optrone/parser.hpp"
@@ -309,7 +310,8 @@ static std::string subcommand_help_message_nested(subcommand_ptr subcommand, opt
 {
     std::string result;
 
-    if (!subcommand->nested_options.empty() || !subcommand->nested_subcommands.empty())
+    bool has_options = !subcommand->nested_options.empty() || !subcommand->inherited_options.empty();
+    if (has_options || !subcommand->nested_subcommands.empty())
     {
         // Add names that lead up to this nested subcommand.
         if (!names_list.empty())
@@ -324,7 +326,13 @@ static std::string subcommand_help_message_nested(subcommand_ptr subcommand, opt
             result += option_help_message(option, customizer);
         }
 
-        if (!subcommand->nested_options.empty() && !subcommand->nested_subcommands.empty())
+        // Inherited options are listed once, under the subcommand declaring them
+        for (option_ptr option : subcommand->inherited_options)
+        {
+            result += option_help_message(option, customizer);
+        }
+
+        if (has_options && !subcommand->nested_subcommands.empty())
         {
             result += "\n";
         }
@@ -343,7 +351,7 @@ static std::string subcommand_help_message_nested(subcommand_ptr subcommand, opt
     return result;
 }
 
-std::string optrone::get_help_message(
+OPTRONE_INLINE std::string optrone::get_help_message(
     std::vector<std::shared_ptr<option_template>>     options,
     std::vector<std::shared_ptr<subcommand_template>> subcommands,
     help_customizer                                   customizer)
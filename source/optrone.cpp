@@ -21,9 +21,10 @@
 #include <utility>
 #include <vector>
 
+#include "optrone/config.hpp"
 #include "optrone/error.hpp"
 
-std::string optrone::format_saec(std::string_view string, bool unformat)
+OPTRONE_INLINE std::string optrone::format_saec(std::string_view string, bool unformat)
 {
     static const std::unordered_map<char, std::string> saecs = {
         { '0', "\x1b[0m"  },
@@ -92,12 +93,12 @@ std::string optrone::format_saec(std::string_view string, bool unformat)
     return result;
 }
 
-std::string optrone::sanitize_saec(std::string_view string)
+OPTRONE_INLINE std::string optrone::sanitize_saec(std::string_view string)
 {
     return std::regex_replace(std::string(string), std::regex("\\$"), "$$");
 }
 
-std::vector<std::pair<std::size_t, std::size_t>> optrone::get_lines(std::string_view string)
+OPTRONE_INLINE std::vector<std::pair<std::size_t, std::size_t>> optrone::get_lines(std::string_view string)
 {
     std::vector<std::pair<std::size_t, std::size_t>> line_infos;
     {
@@ -116,7 +117,7 @@ std::vector<std::pair<std::size_t, std::size_t>> optrone::get_lines(std::string_
     return line_infos;
 }
 
-std::pair<std::size_t, std::size_t> optrone::get_line_row_col(const std::vector<std::pair<std::size_t, std::size_t>> &lines, std::size_t pos)
+OPTRONE_INLINE std::pair<std::size_t, std::size_t> optrone::get_line_row_col(const std::vector<std::pair<std::size_t, std::size_t>> &lines, std::size_t pos)
 {
     for (std::size_t i = 0; i < lines.size(); i++)
     {
@@ -134,7 +135,7 @@ std::pair<std::size_t, std::size_t> optrone::get_line_row_col(const std::vector<
     throw std::out_of_range("Position " + std::to_string(pos) + " is out of range");
 }
 
-std::string optrone::preview_range(std::string_view string, text_range range, int padding, preview_customizer customizer)
+OPTRONE_INLINE std::string optrone::preview_range(std::string_view string, text_range range, int padding, preview_customizer customizer)
 {
     std::size_t end = range.begin + range.length;
 
@@ -229,7 +230,7 @@ std::string optrone::preview_range(std::string_view string, text_range range, in
     return oss.str();
 }
 
-optrone::argument_error::argument_error(std::string_view message, std::string_view cmd_line, text_range range)
+OPTRONE_INLINE optrone::argument_error::argument_error(std::string_view message, std::string_view cmd_line, text_range range)
 try
     : message(message), cmd_line(cmd_line), range(range)
 {
@@ -8,99 +8,269 @@
 /// This project is licensed under the terms of MIT License.
 
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cctype>
+#include <charconv>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <map>
 #include <memory>
+#include <optional>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#include "optrone/config.hpp"
+#include "optrone/dialect.hpp"
 #include "optrone/error.hpp"
+#include "optrone/file.hpp"
 #include "optrone/parser.hpp"
 #include "optrone/template.hpp"
 
+OPTRONE_INLINE std::atomic<std::size_t> optrone::linear_lookup_limit = 8;
+
 // Sanity proofing
 using option_ptr     = std::shared_ptr<optrone::option_template>;
 using option_vec     = std::vector<option_ptr>;
 using subcommand_ptr = std::shared_ptr<optrone::subcommand_template>;
 using subcommand_vec = std::vector<subcommand_ptr>;
 
-/// Determine the token type from the argument.
+/// Determine the token type from the argument in the dialect.
+template <typename dialect>
 static optrone::token::token_type determine_type(std::string_view value)
 {
-    if (value.starts_with("/")) return optrone::token::token_type::switch_option;
-    if (value.starts_with("--")) return optrone::token::token_type::long_option;
-    if (value.starts_with("-")) return optrone::token::token_type::short_option;
+    if constexpr (dialect::microsoft_options)
+    {
+        if (value.starts_with("/")) return optrone::token::token_type::switch_option;
+    }
+    if constexpr (dialect::posix_options)
+    {
+        if (value.starts_with("--")) return optrone::token::token_type::long_option;
+        if (value.starts_with("-")) return optrone::token::token_type::short_option;
+    }
     return optrone::token::token_type::regular;
 }
 
-std::vector<optrone::token> optrone::tokenize(const std::vector<std::string> &args)
+/// Argument viewed in place, with the positions of its first `=` and `:`.
+struct argument_view {
+    std::string_view value;                               ///< Argument.
+    std::size_t      equals = std::string_view::npos;     ///< Position of the first `=`.
+    std::size_t      colon  = std::string_view::npos;     ///< Position of the first `:`.
+};
+
+/// Append the tokens of the argument (split at the value and into bundled
+/// short options, as the dialect does) to the tokens.
+template <typename dialect>
+static void append_tokens(std::vector<optrone::token> &tokens, const argument_view &arg)
 {
-    std::vector<token> tokens;
-    tokens.resize(args.size());
-    for (std::size_t i = 0; i < args.size(); i++)
+    using type = optrone::token::token_type;
+
+    type        kind = determine_type<dialect>(arg.value);
+    std::size_t pos  = std::string_view::npos;
+
+    // 1. Split at `=` or `:` based on whether it is an option or a switch.
+    if constexpr (dialect::value_splitting)
     {
-        tokens[i] = { args[i], determine_type(args[i]) };
+        if (kind == type::long_option || kind == type::short_option)
+            pos = arg.equals;
+        else if (kind == type::switch_option)
+            pos = arg.colon;
     }
 
-    // 1. Split at `=` or `:` based on whether it is an option or a switch.
-    for (std::size_t i = 0; i < tokens.size(); i++)
+    std::string_view name = arg.value.substr(0, pos);
+
+    // 2. Split `-abc` as three tokens: `-a`, `-b` and `-c`.
+    if (dialect::bundling && kind == type::short_option && name.size() > 2)
     {
-        token      &tok = tokens[i];
-        std::size_t pos = std::string::npos;
-        if (tok.type == token::token_type::long_option ||
-            tok.type == token::token_type::short_option)
+        for (char character : name.substr(1))
         {
-            pos = tok.value.find('=');
-        }
-        else if (tok.type == token::token_type::switch_option)
-        {
-            pos = tok.value.find(':');
+            tokens.push_back({ { '-', character }, type::short_option });
         }
+    }
+    else
+    {
+        tokens.push_back({ std::string(name), kind });
+    }
 
-        if (pos != std::string::npos)
-        {
-            token first  = { tok.value.substr(0, pos), tok.type };
-            token second = { tok.value.substr(pos + 1), token::token_type::regular }; // Treat as regular arg
-            tok          = first;
-            tokens.emplace(tokens.begin() + i + 1, second);
-            i++; // Skip processing second, as we know it is fixed to be regular
-        }
+    if (pos != std::string_view::npos)
+    {
+        tokens.push_back({ std::string(arg.value.substr(pos + 1)), type::regular }); // Treat as regular arg
     }
+}
 
-    // 2. Split `-abc` as three tokens: `-a`, `-b` and `-c`.
-    for (std::size_t i = 0; i < tokens.size(); i++)
+/// Adjust the text range of each token.
+static void adjust_ranges(std::vector<optrone::token> &tokens)
+{
+    std::size_t prev = 0;
+    for (optrone::token &tok : tokens)
+    {
+        tok.range.begin   = prev;
+        tok.range.pointer = tok.range.begin;
+        tok.range.length  = tok.value.size();
+        prev += tok.range.length + 1;
+    }
+}
+
+template <typename dialect>
+std::vector<optrone::token> optrone::tokenize(const std::vector<std::string> &args)
+{
+    std::vector<token> tokens;
+    tokens.reserve(args.size());
+    for (const std::string &arg : args)
+    {
+        append_tokens<dialect>(tokens, { arg, arg.find('='), arg.find(':') });
+    }
+
+    adjust_ranges(tokens);
+    return tokens;
+}
+
+OPTRONE_INLINE std::vector<optrone::token> optrone::tokenize(const std::vector<std::string> &args)
+{
+    return tokenize<default_dialect>(args);
+}
+
+/// Mask with the high bit set in each byte of the word that is zero.
+static std::uint64_t find_zero_bytes(std::uint64_t word)
+{
+    constexpr std::uint64_t low_bits = 0x7F7F7F7F7F7F7F7F;
+
+    // Exact (no false positives after a zero byte), unlike `(x - 1) & ~x`
+    return ~(((word & low_bits) + low_bits) | word | low_bits);
+}
+
+/// Scan `argv[0..argc)` into views of the arguments.
+///
+/// If the arguments are back to back in memory (as the Linux kernel lays out
+/// the arguments of `main`), the block is swept 8 bytes at a time, finding the
+/// terminators and the first `=` and `:` of every argument in one pass. Each
+/// terminator is checked against the start of the next argument, and the rest
+/// of the arguments are scanned one by one as soon as they are not contiguous.
+/// Only the bytes from the first argument up to the terminator of the last one
+/// are read: the aligned words in between 8 bytes at a time, and the bytes
+/// before and after them one by one.
+static std::vector<argument_view> scan_argv(int argc, const char *const *argv)
+{
+    std::vector<argument_view> views(std::max(argc, 0));
+    std::size_t                scanned = 0;
+
+    bool contiguous = std::endian::native == std::endian::little && argc > 0;
+#if defined(__SANITIZE_ADDRESS__)
+    contiguous = false; // Words may cover a gap between arguments that are not contiguous
+#endif
+    for (std::size_t i = 1; i < views.size() && contiguous; i++)
     {
-        token &tok = tokens[i];
-        if (tok.type == token::token_type::short_option && tok.value.size() > 2)
+        contiguous = std::less<const char *>{}(argv[i - 1], argv[i]);
+    }
+
+    if (contiguous)
+    {
+        constexpr std::uint64_t ones = 0x0101010101010101;
+
+        const char *last       = argv[views.size() - 1];
+        const char *begin      = argv[0];
+        const char *end        = last + std::strlen(last) + 1;
+        const char *word_begin = begin + (-reinterpret_cast<std::uintptr_t>(begin) & 7);
+        const char *word_end   = end - (reinterpret_cast<std::uintptr_t>(end) & 7);
+
+        const char *start  = begin;
+        std::size_t equals = std::string_view::npos;
+        std::size_t colon  = std::string_view::npos;
+
+        // End the argument at its terminator, and check that the next one
+        // follows it
+        auto end_argument = [&](const char *terminator) {
+            views[scanned++] = { std::string_view(start, terminator - start), equals, colon };
+            equals = colon = std::string_view::npos;
+            start          = terminator + 1;
+            contiguous     = scanned == views.size() || argv[scanned] == start;
+        };
+
+        auto scan_byte = [&](const char *byte) {
+            if (*byte == '=' && equals == std::string_view::npos) equals = byte - start;
+            if (*byte == ':' && colon == std::string_view::npos) colon = byte - start;
+            if (*byte == '\0') end_argument(byte);
+        };
+
+        const char *pos = begin;
+        for (; pos < std::min(word_begin, end) && contiguous; pos++)
         {
-            std::string characters = tok.value.substr(2);
-            tok.value              = std::string("-") + tok.value[1];
+            scan_byte(pos);
+        }
+
+        for (; pos < word_end && contiguous; pos += sizeof(std::uint64_t))
+        {
+            std::uint64_t bytes = 0;
+            std::memcpy(&bytes, pos, sizeof(bytes));
+
+            std::uint64_t ends        = find_zero_bytes(bytes);
+            std::uint64_t equal_signs = find_zero_bytes(bytes ^ (ones * '='));
+            std::uint64_t colons      = find_zero_bytes(bytes ^ (ones * ':'));
 
-            for (std::size_t j = 0; j < characters.size(); j++)
+            // Attribute the `=` and `:` before each terminator to its argument
+            auto take_first = [&](std::uint64_t &found, std::uint64_t before, std::size_t &position) {
+                if (position == std::string_view::npos && (found & before) != 0)
+                {
+                    position = pos + std::countr_zero(found & before) / 8 - start;
+                }
+                found &= ~before;
+            };
+
+            for (; ends != 0 && contiguous; ends &= ends - 1)
             {
-                tokens.emplace(tokens.begin() + i + j + 1, std::string("-") + characters[j], token::token_type::short_option);
+                std::size_t   terminator = std::countr_zero(ends) / 8;
+                std::uint64_t before     = (std::uint64_t(1) << (8 * terminator)) - 1;
+                take_first(equal_signs, before, equals);
+                take_first(colons, before, colon);
+                end_argument(pos + terminator);
             }
 
-            i += characters.size(); // Skip processing the already split args.
+            take_first(equal_signs, ~std::uint64_t(0), equals);
+            take_first(colons, ~std::uint64_t(0), colon);
+        }
+
+        for (; pos < end && contiguous; pos++)
+        {
+            scan_byte(pos);
         }
     }
 
-    // Adjust text range of each token
-    std::size_t prev = 0;
-    for (token &tok : tokens)
+    for (; scanned < views.size(); scanned++)
     {
-        tok.range.begin   = prev;
-        tok.range.pointer = tok.range.begin;
-        tok.range.length  = tok.value.size();
-        prev += tok.range.length + 1;
+        std::string_view value = argv[scanned];
+        views[scanned]         = { value, value.find('='), value.find(':') };
+    }
+
+    return views;
+}
+
+template <typename dialect>
+std::vector<optrone::token> optrone::tokenize_argv(int argc, const char *const *argv)
+{
+    std::vector<token> tokens;
+    tokens.reserve(std::max(argc, 0));
+    for (const argument_view &arg : scan_argv(argc, argv))
+    {
+        append_tokens<dialect>(tokens, arg);
     }
 
+    adjust_ranges(tokens);
     return tokens;
 }
 
-std::string optrone::construct_command_line(const std::vector<token> &tokens)
+OPTRONE_INLINE std::vector<optrone::token> optrone::tokenize_argv(int argc, const char *const *argv)
+{
+    return tokenize_argv<default_dialect>(argc, argv);
+}
+
+OPTRONE_INLINE std::string optrone::construct_command_line(const std::vector<token> &tokens)
 {
     std::string command_line = "";
     for (const token &tok : tokens)
@@ -116,6 +286,211 @@ std::string optrone::construct_command_line(const std::vector<token> &tokens)
     return command_line;
 }
 
+OPTRONE_INLINE void optrone::number_list::append(std::uint64_t first, std::uint64_t last)
+{
+    std::uint64_t added = last - first + 1; // Zero if the range has every number
+    count               = added == 0 || added > std::numeric_limits<std::uint64_t>::max() - count
+                            ? std::numeric_limits<std::uint64_t>::max()
+                            : count + added;
+
+    // Merge consecutive numbers into the last range, unless it is expanded
+    if (ranges.size() > expanded_ranges && ranges.back().last != std::numeric_limits<std::uint64_t>::max() &&
+        ranges.back().last + 1 == first)
+    {
+        ranges.back().last = last;
+        return;
+    }
+
+    ranges.push_back({ .first = first, .last = last });
+}
+
+OPTRONE_INLINE std::span<const std::uint64_t> optrone::number_list::values() const
+{
+    for (; expanded_ranges < ranges.size(); expanded_ranges++)
+    {
+        const range &numbers = ranges[expanded_ranges];
+        for (std::uint64_t number = numbers.first;; number++)
+        {
+            expanded.push_back(number);
+            if (number == numbers.last)
+            {
+                break;
+            }
+        }
+    }
+
+    return expanded;
+}
+
+OPTRONE_INLINE bool optrone::string_map::insert_or_assign(std::string_view key, std::string_view value)
+{
+    std::size_t hash = std::hash<std::string_view>()(key);
+
+    if (!slots.empty())
+    {
+        if (std::size_t slot = find_slot(key, hash); slots[slot] != 0)
+        {
+            // Overwrite the value in place if it fits, otherwise append it
+            entry &assigned = map_entries[slots[slot] - 1];
+            if (value.size() <= assigned.value_length)
+            {
+                text.replace(assigned.value_begin, value.size(), value);
+                unused_size += assigned.value_length - value.size();
+            }
+            else
+            {
+                unused_size += assigned.value_length;
+                assigned.value_begin = text.size();
+                text += value;
+            }
+            assigned.value_length = value.size();
+
+            if (unused_size > text.size() - unused_size)
+            {
+                compact();
+            }
+            return false;
+        }
+    }
+
+    map_entries.push_back({ hash, text.size(), key.size(), text.size() + key.size(), value.size() });
+    text += key;
+    text += value;
+
+    // Keep the table at most half full, rehashing all the entries when growing
+    if (map_entries.size() * 2 > slots.size())
+    {
+        slots.assign(std::max(slots.size() * 2, 16zu), 0);
+        for (std::size_t i = 0; i < map_entries.size(); i++)
+        {
+            std::size_t slot = map_entries[i].hash & (slots.size() - 1);
+            while (slots[slot] != 0)
+            {
+                slot = (slot + 1) & (slots.size() - 1);
+            }
+            slots[slot] = i + 1;
+        }
+    }
+    else
+    {
+        slots[find_slot(key, hash)] = map_entries.size();
+    }
+
+    return true;
+}
+
+OPTRONE_INLINE void optrone::string_map::compact()
+{
+    std::string compacted;
+    compacted.reserve(text.size() - unused_size);
+    for (entry &moved : map_entries)
+    {
+        std::size_t key_begin = compacted.size();
+        compacted.append(text, moved.key_begin, moved.key_length);
+        compacted.append(text, moved.value_begin, moved.value_length);
+        moved.key_begin   = key_begin;
+        moved.value_begin = key_begin + moved.key_length;
+    }
+
+    text        = std::move(compacted);
+    unused_size = 0;
+}
+
+OPTRONE_INLINE std::optional<std::string_view> optrone::string_map::find(std::string_view key) const
+{
+    if (slots.empty())
+    {
+        return std::nullopt;
+    }
+
+    std::size_t slot = find_slot(key, std::hash<std::string_view>()(key));
+    if (slots[slot] == 0)
+    {
+        return std::nullopt;
+    }
+
+    return at(slots[slot] - 1).second;
+}
+
+OPTRONE_INLINE std::pair<std::string_view, std::string_view> optrone::string_map::at(std::size_t index) const
+{
+    const entry     &found = map_entries.at(index);
+    std::string_view view  = text;
+    return { view.substr(found.key_begin, found.key_length), view.substr(found.value_begin, found.value_length) };
+}
+
+OPTRONE_INLINE std::size_t optrone::string_map::find_slot(std::string_view key, std::size_t hash) const
+{
+    std::string_view view = text;
+    for (std::size_t slot = hash & (slots.size() - 1);; slot = (slot + 1) & (slots.size() - 1))
+    {
+        if (slots[slot] == 0)
+        {
+            return slot;
+        }
+
+        const entry &found = map_entries[slots[slot] - 1];
+        if (found.hash == hash && view.substr(found.key_begin, found.key_length) == key)
+        {
+            return slot;
+        }
+    }
+}
+
+OPTRONE_INLINE std::string_view optrone::parsed_argument::value(std::size_t index) const
+{
+    const std::string &given = values.at(index);
+    if (index < files.size() && files[index].mapping)
+    {
+        return files[index].content();
+    }
+    return given;
+}
+
+/// Append the numbers of a delimiter-separated list of numbers and inclusive
+/// ranges of numbers (e.g. `4-100,200`) to the number list, in a single pass
+/// over the list: the delimiters are found with `find` (a vectorized `memchr`)
+/// and the elements are converted in place with `from_chars`.
+/// @return Range of the first invalid element within the list (or of the
+/// delimiter next to it, if it is empty), if any.
+static std::optional<optrone::text_range> append_numbers(optrone::number_list &numbers, std::string_view list, char delimiter)
+{
+    for (std::size_t begin = 0;;)
+    {
+        std::size_t end         = std::min(list.find(delimiter, begin), list.size());
+        const char *element     = list.data() + begin;
+        const char *element_end = list.data() + end;
+
+        if (begin == end)
+        {
+            // Nothing to point at in an empty element, point at the delimiter
+            std::size_t delimiter_pos = begin > 0 ? begin - 1 : begin;
+            return optrone::text_range{ delimiter_pos, list.empty() ? 0zu : 1zu, delimiter_pos };
+        }
+
+        std::uint64_t first  = 0;
+        auto          result = std::from_chars(element, element_end, first);
+        std::uint64_t last   = first;
+        if (result.ec == std::errc() && result.ptr != element_end && *result.ptr == '-')
+        {
+            result = std::from_chars(result.ptr + 1, element_end, last);
+        }
+
+        if (result.ec != std::errc() || result.ptr != element_end || last < first)
+        {
+            return optrone::text_range{ begin, end - begin, static_cast<std::size_t>(std::min(result.ptr, element_end - 1) - list.data()) };
+        }
+
+        numbers.append(first, last);
+
+        if (end == list.size())
+        {
+            return std::nullopt;
+        }
+        begin = end + 1;
+    }
+}
+
 static std::string str_to_lower(std::string_view str)
 {
     std::string result(str);
@@ -123,6 +498,26 @@ static std::string str_to_lower(std::string_view str)
     return result;
 }
 
+/// Validates the list delimiter and the default values of `param_kind::list`
+/// parameters, throws if invalid.
+/// @param kind `"Option"` or `"Subcommand"`, for the error message.
+static void validate_list_params(char delimiter, const std::vector<std::string> &defaults, std::string_view kind)
+{
+    if (std::isdigit(static_cast<unsigned char>(delimiter)) || delimiter == '-')
+    {
+        throw std::invalid_argument(std::string(kind) + " list delimiter cannot be a digit or '-'");
+    }
+
+    optrone::number_list numbers;
+    for (const std::string &value : defaults)
+    {
+        if (append_numbers(numbers, value, delimiter))
+        {
+            throw std::invalid_argument(std::string(kind) + " default value is not a valid list of numbers");
+        }
+    }
+}
+
 /// Validates an option, throws if invalid.
 static void validate_option(option_ptr option)
 {
@@ -172,6 +567,21 @@ static void validate_option(option_ptr option)
     {
         throw std::invalid_argument("Option cannot have default values and variadic parameters");
     }
+
+    if (option->params_kind == optrone::param_kind::list)
+    {
+        validate_list_params(option->list_delimiter, option->defaults, "Option");
+    }
+
+    if (option->params_kind == optrone::param_kind::map && !option->defaults.empty())
+    {
+        throw std::invalid_argument("Option cannot have default values for map parameters");
+    }
+
+    if (option->file_params && option->params_kind != optrone::param_kind::string)
+    {
+        throw std::invalid_argument("Option cannot have file parameters that are lists or maps");
+    }
 }
 
 /// Validates subcommand, nested options and nested subcommands, throws if invalid.
@@ -218,18 +628,38 @@ static void validate_subcommand(subcommand_ptr subcommand)
         throw std::invalid_argument("Subcommand cannot have default values and nested subcommands");
     }
 
+    if (subcommand->params_kind == optrone::param_kind::list)
+    {
+        validate_list_params(subcommand->list_delimiter, subcommand->defaults, "Subcommand");
+    }
+
+    if (subcommand->params_kind == optrone::param_kind::map && !subcommand->defaults.empty())
+    {
+        throw std::invalid_argument("Subcommand cannot have default values for map parameters");
+    }
+
+    if (subcommand->file_params && subcommand->params_kind != optrone::param_kind::string)
+    {
+        throw std::invalid_argument("Subcommand cannot have file parameters that are lists or maps");
+    }
+
     for (option_ptr option : subcommand->nested_options)
     {
         validate_option(option);
     }
 
+    for (option_ptr option : subcommand->inherited_options)
+    {
+        validate_option(option);
+    }
+
     for (subcommand_ptr subcommand : subcommand->nested_subcommands)
     {
         validate_subcommand(subcommand);
     }
 }
 
-void optrone::validate_templates(
+OPTRONE_INLINE void optrone::validate_templates(
     std::vector<std::shared_ptr<option_template>>     options,
     std::vector<std::shared_ptr<subcommand_template>> subcommands)
 {
@@ -244,63 +674,200 @@ void optrone::validate_templates(
     }
 }
 
-/// Find long name from the templates.
-static option_ptr find_long_name(
-    std::string_view long_name,
-    option_vec       options)
-{
-    std::string lower_name = str_to_lower(long_name);
-    for (option_ptr option : options)
+/// Lookup of the options of a scope (the global options, the nested and
+/// inherited options of a subcommand, or the inherited options of an ancestor)
+/// by their names, built once per scope.
+///
+/// The long names of a small scope are scanned linearly, over keys that pack
+/// the length, the first 3 bytes and the last 4 bytes of each name, 8 keys at
+/// a time so that the compiler vectorizes the comparisons. The long names of a
+/// larger scope, or of a scope where different names have the same key (and
+/// the scan would compare them in full), are looked up in a flat
+/// open-addressing hash table instead. The short names are a single string,
+/// searched with `memchr`.
+struct option_lookup {
+    std::vector<std::uint64_t>    keys;          ///< Key of each long name.
+    std::vector<std::string_view> long_names;    ///< Long names, viewing the templates.
+    std::vector<option_ptr>       long_options;  ///< Option of each long name.
+    std::vector<std::uint32_t>    slots;         ///< Index of the long name plus one in each slot (zero for empty), if hashed.
+    std::string                   short_names;   ///< Short names.
+    std::vector<option_ptr>       short_options; ///< Option of each short name.
+
+    /// Build the lookup for the options, choosing the structure by their number.
+    static option_lookup build(const option_vec &options)
     {
-        for (const std::string &option_long_name : option->long_names)
+        option_lookup lookup;
+        for (const option_ptr &option : options)
         {
-            if (lower_name == option_long_name)
+            for (const std::string &long_name : option->long_names)
+            {
+                lookup.keys.emplace_back(get_key(long_name));
+                lookup.long_names.emplace_back(long_name);
+                lookup.long_options.emplace_back(option);
+            }
+
+            for (char short_name : option->short_names)
             {
-                return option;
+                lookup.short_names += short_name;
+                lookup.short_options.emplace_back(option);
             }
         }
+
+        if (lookup.long_names.size() <= optrone::linear_lookup_limit.load(std::memory_order_relaxed) && !lookup.has_shared_keys())
+        {
+            return lookup;
+        }
+
+        // At most half full; the first of the duplicate names wins, as in
+        // the linear scan
+        lookup.slots.resize(std::bit_ceil(lookup.long_names.size() * 2));
+        for (std::size_t i = 0; i < lookup.long_names.size(); i++)
+        {
+            std::size_t slot = lookup.find_slot(lookup.long_names[i]);
+            if (lookup.slots[slot] == 0)
+            {
+                lookup.slots[slot] = i + 1;
+            }
+        }
+        return lookup;
     }
 
-    return nullptr;
-}
+    /// Pack the length (saturated), the first 3 bytes and the last 4 bytes of
+    /// the name. Names of up to 7 bytes are entirely in the key, and the names
+    /// sharing a prefix (e.g. `output-file` and `output-format`) usually
+    /// differ by their end.
+    static std::uint64_t get_key(std::string_view name)
+    {
+        std::uint64_t key = std::min<std::size_t>(name.size(), 0xFF);
+        for (std::size_t i = 0; i < std::min<std::size_t>(name.size(), 3); i++)
+        {
+            key |= std::uint64_t(static_cast<unsigned char>(name[i])) << (8 * (i + 1));
+        }
+        for (std::size_t i = 0; i < std::min<std::size_t>(name.size(), 4); i++)
+        {
+            key |= std::uint64_t(static_cast<unsigned char>(name[name.size() - 1 - i])) << (8 * (7 - i));
+        }
+        return key;
+    }
 
-/// Find short name from the templates.
-static option_ptr find_short_name(
-    char       short_name,
-    option_vec options)
-{
-    char lower_name = std::tolower(short_name);
-    for (option_ptr option : options)
+    /// Check if different long names have the same key.
+    bool has_shared_keys() const
     {
-        for (char option_short_name : option->short_names)
+        for (std::size_t i = 0; i < keys.size(); i++)
         {
-            if (lower_name == option_short_name)
+            for (std::size_t j = 0; j < i; j++)
             {
-                return option;
+                if (keys[i] == keys[j] && long_names[i] != long_names[j])
+                {
+                    return true;
+                }
             }
         }
+        return false;
     }
 
-    return nullptr;
+    /// Find the slot of the name in the hash table, or the empty slot for it.
+    std::size_t find_slot(std::string_view name) const
+    {
+        std::size_t mask = slots.size() - 1;
+        std::size_t slot = std::hash<std::string_view>{}(name) & mask;
+        while (slots[slot] != 0 && long_names[slots[slot] - 1] != name)
+        {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    /// Find the option of the long name.
+    option_ptr find_long(std::string_view name) const
+    {
+        if (!slots.empty())
+        {
+            std::uint32_t found = slots[find_slot(name)];
+            return found != 0 ? long_options[found - 1] : nullptr;
+        }
+
+        std::uint64_t key = get_key(name);
+        for (std::size_t base = 0; base < keys.size(); base += 8)
+        {
+            std::size_t   count   = std::min<std::size_t>(keys.size() - base, 8);
+            std::uint32_t matches = 0;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                matches |= std::uint32_t(keys[base + i] == key) << i;
+            }
+
+            // Names longer than the key need the full comparison
+            for (; matches != 0; matches &= matches - 1)
+            {
+                std::size_t i = base + std::countr_zero(matches);
+                if (name.size() <= 7 || long_names[i] == name)
+                {
+                    return long_options[i];
+                }
+            }
+        }
+
+        return nullptr;
+    }
+
+    /// Find the option of the short name.
+    option_ptr find_short(char name) const
+    {
+        std::size_t found = short_names.find(name);
+        return found != std::string::npos ? short_options[found] : nullptr;
+    }
+};
+
+/// Obtain the name to match against the templates in the dialect.
+template <typename dialect>
+static std::string fold_name(std::string_view name)
+{
+    if constexpr (dialect::case_sensitive)
+        return std::string(name);
+    else
+        return str_to_lower(name);
+}
+
+/// Find long name from the templates.
+template <typename dialect>
+static option_ptr find_long_name(
+    std::string_view     long_name,
+    const option_lookup &lookup)
+{
+    return lookup.find_long(fold_name<dialect>(long_name));
+}
+
+/// Find short name from the templates.
+template <typename dialect>
+static option_ptr find_short_name(
+    char                 short_name,
+    const option_lookup &lookup)
+{
+    return lookup.find_short(dialect::case_sensitive ? short_name : std::tolower(short_name));
 }
 
 /// Find long or short name from the templates.
+template <typename dialect>
 static option_ptr find_option(
     std::string_view           name,
     optrone::token::token_type type,
-    option_vec                 options)
+    const option_lookup       &lookup)
 {
     switch (type)
     {
         case optrone::token::token_type::long_option:
-            return find_long_name(name.substr(2), options);
+            return find_long_name<dialect>(name.substr(2), lookup);
         case optrone::token::token_type::short_option:
-            return find_short_name(name[1], options);
+            if (dialect::bundling || name.size() == 2)
+                return find_short_name<dialect>(name[1], lookup);
+            else
+                return find_long_name<dialect>(name.substr(1), lookup);
         case optrone::token::token_type::switch_option:
             if (name.size() == 2)
-                return find_short_name(name[1], options);
+                return find_short_name<dialect>(name[1], lookup);
             else
-                return find_long_name(name.substr(1), options);
+                return find_long_name<dialect>(name.substr(1), lookup);
         default:
             break;
     }
@@ -309,13 +876,19 @@ static option_ptr find_option(
 }
 
 /// Find subcommand name from the templates.
+/// @param path Appended with the subcommands that lead to the found
+/// subcommand, including it.
+template <typename dialect>
 static subcommand_ptr find_subcommand_name(
-    std::string_view name,
-    subcommand_vec   subcommands)
+    std::string_view                                   name,
+    subcommand_vec                                     subcommands,
+    std::vector<const optrone::subcommand_template *> &path)
 {
-    std::string lower_name = str_to_lower(name);
+    std::string lower_name = fold_name<dialect>(name);
     for (subcommand_ptr subcommand : subcommands)
     {
+        path.push_back(subcommand.get());
+
         for (const std::string &subcommand_name : subcommand->names)
         {
             if (lower_name == subcommand_name)
@@ -324,17 +897,66 @@ static subcommand_ptr find_subcommand_name(
             }
         }
 
-        auto result = find_subcommand_name(name, subcommand->nested_subcommands);
+        auto result = find_subcommand_name<dialect>(name, subcommand->nested_subcommands, path);
 
         if (result)
         {
             return result;
         }
+
+        path.pop_back();
     }
 
     return nullptr;
 }
 
+/// Lookups of the options of the subcommands, each built on the first use of
+/// the subcommand.
+struct scope_lookups {
+    std::unordered_map<const optrone::subcommand_template *, option_lookup> nested;    ///< Nested and inherited options of each subcommand.
+    std::unordered_map<const optrone::subcommand_template *, option_lookup> inherited; ///< Inherited options of each subcommand (as an ancestor).
+
+    /// Obtain the scope chain to find options in for the subcommand at the end
+    /// of the path: its nested and inherited options, then the inherited
+    /// options of its ancestors (nearest first), then the global options.
+    std::vector<const option_lookup *> get_chain(const std::vector<const optrone::subcommand_template *> &path, const option_lookup &global)
+    {
+        std::vector<const option_lookup *> chain;
+
+        if (!path.empty())
+        {
+            const optrone::subcommand_template *subcommand = path.back();
+            auto [lookup, inserted]                        = nested.try_emplace(subcommand);
+            if (inserted)
+            {
+                option_vec options = subcommand->nested_options;
+                options.insert(options.end(), subcommand->inherited_options.begin(), subcommand->inherited_options.end());
+                lookup->second = option_lookup::build(options);
+            }
+            chain.push_back(&lookup->second);
+        }
+
+        for (std::size_t i = path.size(); i-- > 1;)
+        {
+            const optrone::subcommand_template *ancestor = path[i - 1];
+            if (ancestor->inherited_options.empty())
+            {
+                continue;
+            }
+
+            auto [lookup, inserted] = inherited.try_emplace(ancestor);
+            if (inserted)
+            {
+                lookup->second = option_lookup::build(ancestor->inherited_options);
+            }
+            chain.push_back(&lookup->second);
+        }
+
+        chain.push_back(&global);
+        return chain;
+    }
+};
+
 /// Collect values for parameters.
 static std::vector<std::string> collect_values(
     std::size_t                       &index,
@@ -385,22 +1007,119 @@ static std::vector<std::string> collect_values(
     return values;
 }
 
-std::vector<optrone::parsed_argument> optrone::parse_arguments(
-    const std::vector<std::string>                   &args,
-    std::vector<std::shared_ptr<option_template>>     options,
-    std::vector<std::shared_ptr<subcommand_template>> subcommands,
-    const std::vector<std::string>                    global_params,
-    const std::vector<std::string>                    global_defaults,
-    bool                                              global_variadic)
+/// Convert the values of `param_kind::list` parameters into the numbers of the
+/// parsed argument, throws if a value is not a valid list.
+/// @param value_tokens Tokens of the values, preceding the default values.
+static void convert_lists(
+    optrone::parsed_argument       &argument,
+    char                            delimiter,
+    std::span<const optrone::token> value_tokens,
+    const std::string              &cmd_line)
+{
+    for (std::size_t i = 0; i < argument.values.size(); i++)
+    {
+        // The default values are validated with the templates
+        if (auto invalid = append_numbers(argument.numbers, argument.values[i], delimiter))
+        {
+            const optrone::text_range &range = value_tokens[i].range;
+            if (range.length == 0)
+            {
+                // Point at the space before the empty value
+                throw optrone::argument_error("Expected a list of numbers", cmd_line, { range.begin - 1, 1, range.begin - 1 });
+            }
+            throw optrone::argument_error("Invalid number or range of numbers", cmd_line, { range.begin + invalid->begin, invalid->length, range.begin + invalid->pointer });
+        }
+    }
+
+    argument.values.clear();
+}
+
+/// Refer to the files of the `@path` values of parameters with `file_params`,
+/// without opening them, and unescape the `@@` values to their literal `@`.
+static void refer_files(optrone::parsed_argument &argument)
+{
+    for (std::size_t i = 0; i < argument.values.size(); i++)
+    {
+        std::string &value = argument.values[i];
+        if (value.starts_with("@@"))
+        {
+            value.erase(0, 1);
+        }
+        else if (value.size() > 1 && value.starts_with('@'))
+        {
+            argument.files.resize(argument.values.size());
+            argument.files[i] = { .path = value.substr(1), .mapping = std::make_shared<optrone::file_mapping>() };
+        }
+    }
+}
+
+/// Split the `key=value` values of `param_kind::map` parameters in place and
+/// insert them into the entries, throws if a value is not an entry or if a key
+/// is duplicated with `unique_keys`.
+/// @param value_tokens Tokens of the values.
+static void insert_entries(
+    optrone::string_map            &entries,
+    const std::vector<std::string> &values,
+    bool                            unique_keys,
+    std::span<const optrone::token> value_tokens,
+    const std::string              &cmd_line)
+{
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        std::string_view           value  = values[i];
+        std::size_t                equals = value.find('=');
+        const optrone::text_range &range  = value_tokens[i].range;
+
+        if (value.empty())
+        {
+            // Point at the space before the empty value
+            throw optrone::argument_error("Expected an entry as key=value", cmd_line, { range.begin - 1, 1, range.begin - 1 });
+        }
+        if (equals == 0 || equals == std::string_view::npos)
+        {
+            throw optrone::argument_error("Expected an entry as key=value", cmd_line, range);
+        }
+
+        if (!entries.insert_or_assign(value.substr(0, equals), value.substr(equals + 1)) && unique_keys)
+        {
+            throw optrone::argument_error("Duplicate key", cmd_line, { range.begin, equals, range.begin });
+        }
+    }
+}
+
+/// Parse all the tokens.
+/// @see optrone::parse_arguments for list of exceptions.
+template <typename dialect>
+static std::vector<optrone::parsed_argument> parse_tokens(
+    const std::vector<optrone::token> &tokens,
+    const option_vec                  &options,
+    const subcommand_vec              &subcommands,
+    const std::vector<std::string>    &global_params,
+    const std::vector<std::string>    &global_defaults,
+    bool                               global_variadic)
 {
+    using namespace optrone;
+
     validate_templates(options, subcommands);
 
-    std::vector<token> tokens   = tokenize(args);
-    std::string        cmd_line = construct_command_line(tokens);
+    std::string cmd_line = construct_command_line(tokens);
 
     std::shared_ptr<subcommand_template> nested              = nullptr; // Currently nested subcommand to match for, or match global if not found
     std::size_t                          global_values_count = 0;       // NUmber of values provided for global parameters
 
+    // Lookups of the global options and of the options of the subcommands,
+    // and the scope chain of the currently nested subcommand
+    option_lookup                            global_lookup = option_lookup::build(options);
+    scope_lookups                            lookups;
+    std::vector<const subcommand_template *> nested_path;                     // Subcommands that lead to the nested subcommand, including it
+    std::vector<const option_lookup *>       scope_chain = { &global_lookup }; // Lookups to find options in, in order
+
+    // Index of the first occurrence of each option with map parameters in its
+    // scope, the global scope (npos) for the global options, and the argument
+    // of the currently nested subcommand for the options of the subcommands
+    std::map<std::pair<const option_template *, std::size_t>, std::size_t> map_arguments;
+    std::size_t                                                            nested_argument = std::string_view::npos;
+
     // Parse all tokens
     std::vector<parsed_argument> result;
     for (std::size_t index = 0; index < tokens.size();)
@@ -409,24 +1128,29 @@ std::vector<optrone::parsed_argument> optrone::parse_arguments(
 
         if (tok.type == token::token_type::regular)
         {
-            std::shared_ptr<subcommand_template> matched = nullptr;
+            std::shared_ptr<subcommand_template>     matched = nullptr;
+            std::vector<const subcommand_template *> path;
 
             if (nested)
             {
-                matched = find_subcommand_name(tok.value, { nested });
+                path    = std::vector(nested_path.begin(), nested_path.end() - 1); // Ancestors of the nested subcommand
+                matched = find_subcommand_name<dialect>(tok.value, { nested }, path);
             }
 
             if (!matched)
             {
-                nested  = nullptr;
-                matched = find_subcommand_name(tok.value, subcommands);
+                nested          = nullptr;
+                nested_argument = std::string_view::npos;
+                scope_chain     = { &global_lookup };
+                path.clear();
+                matched = find_subcommand_name<dialect>(tok.value, subcommands, path);
             }
 
             if (!matched)
             {
                 if (global_values_count < global_params.size() || global_variadic)
                 {
-                    result.push_back({ {}, {}, { tok.value }, true });
+                    result.push_back({ .values = { tok.value }, .is_global = true });
                     global_values_count++;
                     index++;
                     continue;
@@ -437,30 +1161,51 @@ std::vector<optrone::parsed_argument> optrone::parse_arguments(
                 }
             }
 
-            index++;
-            auto values = collect_values(index, tokens, matched->params, matched->defaults, matched->variadic);
+            std::size_t first_value = ++index;
+            auto        values      = collect_values(index, tokens, matched->params, matched->defaults, matched->variadic);
             if (values.size() < matched->params.size())
             {
                 throw argument_error("Too vew values provided for parameters", cmd_line, tok.range);
             }
 
-            result.push_back({ {}, matched, values });
-            nested = matched; // Find for nested subcommands
+            auto value_tokens = std::span(tokens).subspan(first_value, index - first_value);
+            if (matched->params_kind == param_kind::map)
+            {
+                result.push_back({ .ref_subcommand = matched });
+                insert_entries(result.back().entries, values, matched->map_unique_keys, value_tokens, cmd_line);
+            }
+            else
+            {
+                result.push_back({ .ref_subcommand = matched, .values = values });
+                if (matched->params_kind == param_kind::list)
+                {
+                    convert_lists(result.back(), matched->list_delimiter, value_tokens, cmd_line);
+                }
+                else if (matched->file_params)
+                {
+                    refer_files(result.back());
+                }
+            }
+            nested          = matched; // Find for nested subcommands
+            nested_argument = result.size() - 1;
+            nested_path     = std::move(path);
+            scope_chain     = lookups.get_chain(nested_path, global_lookup);
         }
         else if (tok.type == token::token_type::long_option ||
                  tok.type == token::token_type::short_option ||
                  tok.type == token::token_type::switch_option)
         {
             std::shared_ptr<option_template> matched = nullptr;
+            const option_lookup             *scope   = nullptr;
 
-            if (nested)
-            {
-                matched = find_option(tok.value, tok.type, nested->nested_options);
-            }
-
-            if (!matched)
+            for (const option_lookup *lookup : scope_chain)
             {
-                matched = find_option(tok.value, tok.type, options);
+                matched = find_option<dialect>(tok.value, tok.type, *lookup);
+                if (matched)
+                {
+                    scope = lookup;
+                    break;
+                }
             }
 
             if (!matched)
@@ -468,14 +1213,38 @@ std::vector<optrone::parsed_argument> optrone::parse_arguments(
                 throw argument_error("Unrecognized option", cmd_line, tok.range);
             }
 
-            index++;
-            auto values = collect_values(index, tokens, matched->params, matched->defaults, matched->variadic);
+            std::size_t first_value = ++index;
+            auto        values      = collect_values(index, tokens, matched->params, matched->defaults, matched->variadic);
             if (values.size() < matched->params.size())
             {
                 throw argument_error("Too vew values provided for parameters", cmd_line, tok.range);
             }
 
-            result.push_back({ matched, {}, values });
+            auto value_tokens = std::span(tokens).subspan(first_value, index - first_value);
+            if (matched->params_kind == param_kind::map)
+            {
+                // Merge the entries of all the occurrences in the scope into the
+                // first one
+                std::size_t scope_argument        = scope == &global_lookup ? std::string_view::npos : nested_argument;
+                auto [first_occurrence, inserted] = map_arguments.try_emplace({ matched.get(), scope_argument }, result.size());
+                if (inserted)
+                {
+                    result.push_back({ .ref_option = matched });
+                }
+                insert_entries(result[first_occurrence->second].entries, values, matched->map_unique_keys, value_tokens, cmd_line);
+            }
+            else
+            {
+                result.push_back({ .ref_option = matched, .values = values });
+                if (matched->params_kind == param_kind::list)
+                {
+                    convert_lists(result.back(), matched->list_delimiter, value_tokens, cmd_line);
+                }
+                else if (matched->file_params)
+                {
+                    refer_files(result.back());
+                }
+            }
         }
         else
             index++;
@@ -489,9 +1258,77 @@ std::vector<optrone::parsed_argument> optrone::parse_arguments(
         auto to_add = std::vector(global_defaults.begin() + first, global_defaults.begin() + last);
         for (std::string add : to_add)
         {
-            result.push_back({ {}, {}, { add }, true });
+            result.push_back({ .values = { add }, .is_global = true });
         }
     }
 
     return result;
 }
+
+template <typename dialect>
+std::vector<optrone::parsed_argument> optrone::parse_arguments(
+    const std::vector<std::string>                   &args,
+    std::vector<std::shared_ptr<option_template>>     options,
+    std::vector<std::shared_ptr<subcommand_template>> subcommands,
+    const std::vector<std::string>                    global_params,
+    const std::vector<std::string>                    global_defaults,
+    bool                                              global_variadic)
+{
+    return parse_tokens<dialect>(tokenize<dialect>(args), options, subcommands, global_params, global_defaults, global_variadic);
+}
+
+OPTRONE_INLINE std::vector<optrone::parsed_argument> optrone::parse_arguments(
+    const std::vector<std::string>                   &args,
+    std::vector<std::shared_ptr<option_template>>     options,
+    std::vector<std::shared_ptr<subcommand_template>> subcommands,
+    const std::vector<std::string>                    global_params,
+    const std::vector<std::string>                    global_defaults,
+    bool                                              global_variadic)
+{
+    return parse_arguments<default_dialect>(args, options, subcommands, global_params, global_defaults, global_variadic);
+}
+
+template <typename dialect>
+std::vector<optrone::parsed_argument> optrone::parse_argv(
+    int                                               argc,
+    const char *const                                *argv,
+    std::vector<std::shared_ptr<option_template>>     options,
+    std::vector<std::shared_ptr<subcommand_template>> subcommands,
+    const std::vector<std::string>                    global_params,
+    const std::vector<std::string>                    global_defaults,
+    bool                                              global_variadic)
+{
+    return parse_tokens<dialect>(tokenize_argv<dialect>(argc, argv), options, subcommands, global_params, global_defaults, global_variadic);
+}
+
+OPTRONE_INLINE std::vector<optrone::parsed_argument> optrone::parse_argv(
+    int                                               argc,
+    const char *const                                *argv,
+    std::vector<std::shared_ptr<option_template>>     options,
+    std::vector<std::shared_ptr<subcommand_template>> subcommands,
+    const std::vector<std::string>                    global_params,
+    const std::vector<std::string>                    global_defaults,
+    bool                                              global_variadic)
+{
+    return parse_argv<default_dialect>(argc, argv, options, subcommands, global_params, global_defaults, global_variadic);
+}
+
+// The compiled library provides the predefined dialects, the header-only mode
+// instantiates any dialect on use
+#if !defined(OPTRONE_HEADER_ONLY)
+    #define OPTRONE_INSTANTIATE_DIALECT(dialect)                                                                                   \
+        template std::vector<optrone::token> optrone::tokenize<dialect>(const std::vector<std::string> &);                        \
+        template std::vector<optrone::token> optrone::tokenize_argv<dialect>(int, const char *const *);                           \
+        template std::vector<optrone::parsed_argument> optrone::parse_arguments<dialect>(                                         \
+            const std::vector<std::string> &, option_vec, subcommand_vec, const std::vector<std::string>,                         \
+            const std::vector<std::string>, bool);                                                                                \
+        template std::vector<optrone::parsed_argument> optrone::parse_argv<dialect>(                                              \
+            int, const char *const *, option_vec, subcommand_vec, const std::vector<std::string>, const std::vector<std::string>, \
+            bool);
+
+OPTRONE_INSTANTIATE_DIALECT(optrone::default_dialect)
+OPTRONE_INSTANTIATE_DIALECT(optrone::posix_dialect)
+OPTRONE_INSTANTIATE_DIALECT(optrone::microsoft_dialect)
+
+    #undef OPTRONE_INSTANTIATE_DIALECT
+#endif
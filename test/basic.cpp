@@ -9,14 +9,22 @@
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <format>
+#include <fstream>
+#include <limits>
 #include <memory>
+#include <random>
 #include <ranges>
 #include <string>
+#include <system_error>
 #include <vector>
 
 #include "doctest/doctest.h"
+#include "optrone/error.hpp"
 #include "optrone/parser.hpp"
 #include "optrone/template.hpp"
 
@@ -248,3 +256,300 @@ TEST_CASE("Global parameters testing")
         }
     }
 }
+
+TEST_CASE("Scope lookup parsing")
+{
+    // Names sharing a prefix, a duplicate name (the first option wins) and
+    // enough names to be hashed
+    std::vector<std::shared_ptr<optrone::option_template>> options;
+    for (std::size_t i : std::views::iota(0zu, 100zu))
+    {
+        options.emplace_back(std::make_shared<optrone::option_template>(optrone::option_template{
+            .description = "Option.",
+            .short_names = { static_cast<char>('a' + i % 26) },
+            .long_names  = { std::format("output-format-{}", i), i < 2 ? "duplicate" : std::format("o{}", i) },
+        }));
+    }
+
+    for (std::size_t count : { 2zu, 100zu })
+    {
+        SUBCASE(std::format("Options: {}", count).c_str())
+        {
+            auto scope = options | std::views::take(count) | std::ranges::to<std::vector>();
+
+            for (std::size_t i : std::views::iota(0zu, count))
+            {
+                auto parsed_args = optrone::parse_arguments({ std::format("--output-format-{}", i), std::format("/OUTPUT-FORMAT-{}", i) }, scope, {});
+
+                REQUIRE(parsed_args.size() == 2);
+                CHECK(parsed_args[0].ref_option.lock() == scope[i]);
+                CHECK(parsed_args[1].ref_option.lock() == scope[i]);
+            }
+
+            auto parsed_args = optrone::parse_arguments({ "--duplicate", "-b" }, scope, {});
+
+            REQUIRE(parsed_args.size() == 2);
+            CHECK(parsed_args[0].ref_option.lock() == scope[0]);
+            CHECK(parsed_args[1].ref_option.lock() == scope[1]);
+
+            CHECK_THROWS_AS(optrone::parse_arguments({ "--output-format" }, scope, {}), optrone::argument_error);
+            CHECK_THROWS_AS(optrone::parse_arguments({ "--output-format-100" }, scope, {}), optrone::argument_error);
+        }
+    }
+}
+
+TEST_CASE("Argv tokenization")
+{
+    std::vector<std::string> args = { "--name-1=value", "-abc", "/NAME-2:VALUE", "", "regular=value:", "-", "--name-3" };
+
+    // Back to back, as laid out by the kernel, and then with a gap after the
+    // third argument
+    for (std::size_t gap : { args.size(), 3zu })
+    {
+        SUBCASE(std::format("Gap: {}", gap).c_str())
+        {
+            std::string              block = "program";
+            std::vector<std::size_t>  offsets;
+            for (std::size_t i : std::views::iota(0zu, args.size()))
+            {
+                block += '\0';
+                if (i == gap) block += std::string("gap=:") + '\0';
+                offsets.emplace_back(block.size());
+                block += args[i];
+            }
+            block += '\0';
+
+            auto argv = offsets | std::views::transform([&](std::size_t offset) { return block.data() + offset; }) | std::ranges::to<std::vector<const char *>>();
+
+            auto expected = optrone::tokenize(args);
+            auto tokens   = optrone::tokenize_argv(argv.size(), argv.data());
+
+            REQUIRE(tokens.size() == expected.size());
+            for (std::size_t i : std::views::iota(0zu, tokens.size()))
+            {
+                CHECK(tokens[i].value == expected[i].value);
+                CHECK(tokens[i].type == expected[i].type);
+                CHECK(tokens[i].range.begin == expected[i].range.begin);
+            }
+        }
+    }
+}
+
+TEST_CASE("List parameters parsing")
+{
+    auto option = std::make_shared<optrone::option_template>(optrone::option_template{
+        .description = "Option.",
+        .long_names  = { "ids" },
+        .params      = { "ids" },
+        .params_kind = optrone::param_kind::list,
+    });
+
+    auto subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+        .description    = "Subcommand.",
+        .names          = { "remove" },
+        .params         = { "indices" },
+        .defaults       = { "0" },
+        .params_kind    = optrone::param_kind::list,
+        .list_delimiter = ';',
+    });
+
+    auto parsed_args = optrone::parse_arguments({ "--ids=7,1,2,3,10-12", "remove", "4-100;200;18446744073709551615", "remove" }, { option }, { subcommand });
+
+    REQUIRE(parsed_args.size() == 3);
+    CHECK(parsed_args[0].values.empty());
+    REQUIRE(parsed_args[0].numbers.ranges.size() == 3);
+    CHECK(parsed_args[0].numbers.ranges[1].first == 1);
+    CHECK(parsed_args[0].numbers.ranges[1].last == 3);
+    CHECK(parsed_args[0].numbers.count == 7);
+    CHECK(std::ranges::equal(parsed_args[0].numbers.values(), std::vector<std::uint64_t>{ 7, 1, 2, 3, 10, 11, 12 }));
+
+    REQUIRE(parsed_args[1].numbers.ranges.size() == 3);
+    CHECK(parsed_args[1].numbers.ranges[0].first == 4);
+    CHECK(parsed_args[1].numbers.ranges[0].last == 100);
+    CHECK(parsed_args[1].numbers.ranges[2].first == std::numeric_limits<std::uint64_t>::max());
+    CHECK(parsed_args[1].numbers.count == 99);
+    CHECK(parsed_args[1].numbers.values().size() == 99);
+
+    CHECK(std::ranges::equal(parsed_args[2].numbers.values(), std::vector<std::uint64_t>{ 0 }));
+
+    optrone::number_list numbers;
+    numbers.append(0, std::numeric_limits<std::uint64_t>::max());
+    CHECK(numbers.count == std::numeric_limits<std::uint64_t>::max());
+}
+
+TEST_CASE("Map parameters parsing")
+{
+    auto option = std::make_shared<optrone::option_template>(optrone::option_template{
+        .description = "Option.",
+        .long_names  = { "set" },
+        .params      = { "entry" },
+        .params_kind = optrone::param_kind::map,
+    });
+
+    auto subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+        .description = "Subcommand.",
+        .names       = { "env" },
+        .variadic    = true,
+        .params_kind = optrone::param_kind::map,
+    });
+
+    auto parsed_args = optrone::parse_arguments({ "--set", "a=1", "env", "path=/usr/bin", "empty=", "--set=b=2=3", "--set", "a=4" }, { option }, { subcommand });
+
+    REQUIRE(parsed_args.size() == 2);
+    CHECK(parsed_args[0].ref_option.lock() == option);
+    CHECK(parsed_args[0].values.empty());
+    REQUIRE(parsed_args[0].entries.size() == 2);
+    CHECK(parsed_args[0].entries.find("a") == "4");
+    CHECK(parsed_args[0].entries.find("b") == "2=3");
+    CHECK_FALSE(parsed_args[0].entries.contains("c"));
+    CHECK(parsed_args[0].entries.at(0).first == "a");
+
+    CHECK(parsed_args[1].ref_subcommand.lock() == subcommand);
+    REQUIRE(parsed_args[1].entries.size() == 2);
+    CHECK(parsed_args[1].entries.find("path") == "/usr/bin");
+    CHECK(parsed_args[1].entries.find("empty") == "");
+
+    // The occurrences of a nested option are merged per subcommand
+    auto nested = std::make_shared<optrone::option_template>(optrone::option_template{
+        .description = "Option.",
+        .long_names  = { "label" },
+        .params      = { "entry" },
+        .params_kind = optrone::param_kind::map,
+    });
+
+    auto first = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+        .description    = "First.",
+        .names          = { "first" },
+        .nested_options = { nested },
+    });
+
+    auto second = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+        .description    = "Second.",
+        .names          = { "second" },
+        .nested_options = { nested },
+    });
+
+    parsed_args = optrone::parse_arguments({ "first", "--label", "a=1", "--label", "b=2", "second", "--label", "a=3" }, {}, { first, second });
+
+    REQUIRE(parsed_args.size() == 4);
+    CHECK(parsed_args[1].entries.size() == 2);
+    CHECK(parsed_args[3].entries.size() == 1);
+    CHECK(parsed_args[3].entries.find("a") == "3");
+
+    optrone::string_map entries;
+    for (std::size_t i : std::views::iota(0zu, 1000zu))
+    {
+        CHECK(entries.insert_or_assign(std::format("key-{}", i), std::format("value-{}", i)));
+    }
+    CHECK_FALSE(entries.insert_or_assign("key-500", "value"));
+    CHECK(entries.size() == 1000);
+    CHECK(entries.find("key-999") == "value-999");
+    CHECK(entries.find("key-500") == "value");
+    CHECK(std::ranges::distance(entries.entries()) == 1000);
+
+    // Overwriting with longer values compacts the old ones away
+    for (std::size_t i : std::views::iota(0zu, 1000zu))
+    {
+        entries.insert_or_assign("key-0", std::string(i % 100, 'x'));
+    }
+    CHECK(entries.find("key-0") == std::string(99, 'x'));
+    CHECK(entries.find("key-1") == "value-1");
+    CHECK(entries.at(999).second == "value-999");
+    CHECK(entries.unused_size <= entries.text.size() - entries.unused_size);
+}
+
+TEST_CASE("File parameters parsing")
+{
+    auto option = std::make_shared<optrone::option_template>(optrone::option_template{
+        .description = "Option.",
+        .long_names  = { "data" },
+        .params      = { "data" },
+        .file_params = true,
+    });
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / std::format("optrone_file_params_{:x}.json", std::random_device {}());
+    std::ofstream(path, std::ios::binary) << "{ \"key\": \"value\" }";
+
+    auto parsed_args = optrone::parse_arguments({ "--data=@" + path.string(), "--data", "@", "--data", "@missing-file", "--data", "@@handle" }, { option }, {});
+
+    REQUIRE(parsed_args.size() == 4);
+    CHECK(parsed_args[0].values[0] == "@" + path.string());
+    REQUIRE(parsed_args[0].files.size() == 1);
+    CHECK(parsed_args[0].files[0].path == path.string());
+    CHECK(parsed_args[0].value(0) == "{ \"key\": \"value\" }");
+
+    // Copies share the mapping
+    optrone::file_value copy = parsed_args[0].files[0];
+    CHECK(copy.content().data() == parsed_args[0].value(0).data());
+
+    CHECK(parsed_args[1].files.empty());
+    CHECK(parsed_args[1].value(0) == "@");
+
+    CHECK_THROWS_AS(parsed_args[2].value(0), std::system_error);
+
+    CHECK(parsed_args[3].files.empty());
+    CHECK(parsed_args[3].value(0) == "@handle");
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Inherited options parsing")
+{
+    auto make_option = [](std::string long_name) {
+        return std::make_shared<optrone::option_template>(optrone::option_template{
+            .description = "Option.",
+            .long_names  = { long_name },
+        });
+    };
+
+    auto global_option   = make_option("global");
+    auto verbose_option  = make_option("verbose");
+    auto output_option   = make_option("output");
+    auto override_option = make_option("verbose");
+    auto region_option   = make_option("region");
+
+    auto create_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+        .description    = "Nested subcommand.",
+        .names          = { "create" },
+        .nested_options = { override_option },
+    });
+
+    auto vm_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+        .description        = "Nested subcommand.",
+        .names              = { "vm" },
+        .inherited_options  = { output_option },
+        .nested_subcommands = { create_subcommand },
+    });
+
+    auto subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+        .description        = "Subcommand.",
+        .names              = { "cloud" },
+        .nested_options     = { region_option },
+        .inherited_options  = { verbose_option },
+        .nested_subcommands = { vm_subcommand },
+    });
+
+    auto parsed_args = optrone::parse_arguments({ "cloud", "--verbose", "--region", "vm", "--verbose", "--output", "create", "--verbose", "--output", "--global" }, { global_option }, { subcommand });
+
+    REQUIRE(parsed_args.size() == 10);
+    CHECK(parsed_args[1].ref_option.lock() == verbose_option);
+    CHECK(parsed_args[2].ref_option.lock() == region_option);
+    CHECK(parsed_args[4].ref_option.lock() == verbose_option);
+    CHECK(parsed_args[5].ref_option.lock() == output_option);
+    CHECK(parsed_args[7].ref_option.lock() == override_option); // Nearest first
+    CHECK(parsed_args[8].ref_option.lock() == output_option);
+    CHECK(parsed_args[9].ref_option.lock() == global_option);
+
+    // Nested options are not inherited, and inherited options do not apply
+    // outside of the subcommand
+    CHECK_THROWS_AS(optrone::parse_arguments({ "cloud", "vm", "--region" }, {}, { subcommand }), optrone::argument_error);
+    CHECK_THROWS_AS(optrone::parse_arguments({ "--verbose" }, {}, { subcommand }), optrone::argument_error);
+
+    // Matching a nested subcommand directly (as the parser allows) still
+    // inherits from its ancestors
+    parsed_args = optrone::parse_arguments({ "create", "--output" }, {}, { subcommand });
+
+    REQUIRE(parsed_args.size() == 2);
+    CHECK(parsed_args[0].ref_subcommand.lock() == create_subcommand);
+    CHECK(parsed_args[1].ref_option.lock() == output_option);
+}
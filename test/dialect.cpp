@@ -0,0 +1,103 @@
+/// @file
+///
+/// @author    Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file tests argument parsing of Optrone in the predefined
+/// dialects.
+///
+/// This project is licensed under the terms of MIT license.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "optrone/dialect.hpp"
+#include "optrone/error.hpp"
+#include "optrone/parser.hpp"
+#include "optrone/template.hpp"
+
+TEST_CASE("Dialect tokenization")
+{
+    using type = optrone::token::token_type;
+
+    SUBCASE("Default dialect")
+    {
+        auto tokens = optrone::tokenize<optrone::default_dialect>({ "/usr/lib", "-1", "--name=value" });
+
+        REQUIRE(tokens.size() == 4);
+        CHECK(tokens[0].type == type::switch_option);
+        CHECK(tokens[1].type == type::short_option);
+        CHECK(tokens[2].type == type::long_option);
+        CHECK(tokens[3].type == type::regular);
+    }
+
+    SUBCASE("POSIX dialect")
+    {
+        auto tokens = optrone::tokenize<optrone::posix_dialect>({ "/usr/lib", "-ab", "/NAME:VALUE" });
+
+        REQUIRE(tokens.size() == 4);
+        CHECK(tokens[0].type == type::regular);
+        CHECK(tokens[1].value == "-a");
+        CHECK(tokens[2].value == "-b");
+        CHECK(tokens[3].value == "/NAME:VALUE");
+        CHECK(tokens[3].type == type::regular);
+    }
+
+    SUBCASE("Microsoft dialect")
+    {
+        auto tokens = optrone::tokenize<optrone::microsoft_dialect>({ "-1", "--name=value", "/NAME:VALUE" });
+
+        REQUIRE(tokens.size() == 4);
+        CHECK(tokens[0].type == type::regular);
+        CHECK(tokens[1].type == type::regular);
+        CHECK(tokens[1].value == "--name=value");
+        CHECK(tokens[2].type == type::switch_option);
+        CHECK(tokens[3].value == "VALUE");
+    }
+}
+
+TEST_CASE("Dialect argument parsing")
+{
+    auto option = std::make_shared<optrone::option_template>(optrone::option_template{
+        .description = "Option.",
+        .short_names = { 'n' },
+        .long_names  = { "name" },
+        .params      = { "param" },
+    });
+
+    auto subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+        .description = "Subcommand.",
+        .names       = { "copy" },
+        .params      = { "from", "to" },
+    });
+
+    SUBCASE("POSIX dialect")
+    {
+        auto parsed_args = optrone::parse_arguments<optrone::posix_dialect>({ "copy", "/usr/lib", "/tmp", "--name=value" }, { option }, { subcommand });
+
+        REQUIRE(parsed_args.size() == 2);
+        CHECK(parsed_args[0].ref_subcommand.lock() == subcommand);
+        CHECK(parsed_args[0].values == std::vector<std::string>{ "/usr/lib", "/tmp" });
+        CHECK(parsed_args[1].ref_option.lock() == option);
+        CHECK(parsed_args[1].values == std::vector<std::string>{ "value" });
+
+        CHECK_THROWS_AS(optrone::parse_arguments<optrone::posix_dialect>({ "/NAME:VALUE" }, { option }, { subcommand }), optrone::argument_error);
+    }
+
+    SUBCASE("Microsoft dialect")
+    {
+        auto parsed_args = optrone::parse_arguments<optrone::microsoft_dialect>({ "COPY", "-1", "--2", "/N:VALUE" }, { option }, { subcommand });
+
+        REQUIRE(parsed_args.size() == 2);
+        CHECK(parsed_args[0].ref_subcommand.lock() == subcommand);
+        CHECK(parsed_args[0].values == std::vector<std::string>{ "-1", "--2" });
+        CHECK(parsed_args[1].ref_option.lock() == option);
+        CHECK(parsed_args[1].values == std::vector<std::string>{ "VALUE" });
+
+        CHECK_THROWS_AS(optrone::parse_arguments<optrone::microsoft_dialect>({ "--name=value" }, { option }, { subcommand }), optrone::argument_error);
+    }
+}
@@ -125,6 +125,44 @@ TEST_CASE("Template validation")
     });
 
     CHECK_THROWS_AS(optrone::parse_arguments({}, {}, { mutex_features_used_3_subcommand }), std::invalid_argument);
+
+    auto digit_delimiter_option = std::make_shared<optrone::option_template>(optrone::option_template{
+        .description    = "Digit delimiter option.",
+        .long_names     = { "name-1" },
+        .params         = { "param-1" },
+        .params_kind    = optrone::param_kind::list,
+        .list_delimiter = '1',
+    });
+
+    CHECK_THROWS_AS(optrone::parse_arguments({}, { digit_delimiter_option }, {}), std::invalid_argument);
+
+    auto invalid_default_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+        .description = "Invalid default subcommand.",
+        .names       = { "name-1" },
+        .params      = { "param-1" },
+        .defaults    = { "1-a" },
+        .params_kind = optrone::param_kind::list,
+    });
+
+    CHECK_THROWS_AS(optrone::parse_arguments({}, {}, { invalid_default_subcommand }), std::invalid_argument);
+
+    auto map_default_option = std::make_shared<optrone::option_template>(optrone::option_template{
+        .description = "Map default option.",
+        .long_names  = { "name-1" },
+        .params      = { "param-1" },
+        .defaults    = { "key=value" },
+        .params_kind = optrone::param_kind::map,
+    });
+
+    CHECK_THROWS_AS(optrone::parse_arguments({}, { map_default_option }, {}), std::invalid_argument);
+
+    auto invalid_inherited_subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+        .description       = "Invalid inherited subcommand.",
+        .names             = { "name-1" },
+        .inherited_options = { no_name_option },
+    });
+
+    CHECK_THROWS_AS(optrone::parse_arguments({}, {}, { invalid_inherited_subcommand }), std::invalid_argument);
 }
 
 TEST_CASE("Parsing error")
@@ -154,4 +192,35 @@ TEST_CASE("Parsing error")
 
         CHECK_THROWS_AS(optrone::parse_arguments(args, { params_option }, {}), optrone::argument_error);
     }
+
+    // Invalid lists
+
+    auto list_option = std::make_shared<optrone::option_template>(optrone::option_template{
+        .description = "List option.",
+        .short_names = { 'l' },
+        .params      = { "param-1" },
+        .params_kind = optrone::param_kind::list,
+    });
+
+    for (std::string list : { "", "1,", ",1", "1,,2", "a", "1-", "-1", "5-4", "1-2-3", "18446744073709551616" })
+    {
+        CHECK_THROWS_AS(optrone::parse_arguments({ "-l", list }, { list_option }, {}), optrone::argument_error);
+    }
+
+    // Invalid entries
+
+    auto map_option = std::make_shared<optrone::option_template>(optrone::option_template{
+        .description     = "Map option.",
+        .short_names     = { 'm' },
+        .params          = { "param-1" },
+        .params_kind     = optrone::param_kind::map,
+        .map_unique_keys = true,
+    });
+
+    for (std::string entry : { "", "key", "=value" })
+    {
+        CHECK_THROWS_AS(optrone::parse_arguments({ "-m", entry }, { map_option }, {}), optrone::argument_error);
+    }
+
+    CHECK_THROWS_AS(optrone::parse_arguments({ "-m", "key=1", "-m", "key=2" }, { map_option }, {}), optrone::argument_error);
 }
@@ -0,0 +1,85 @@
+/// @file
+///
+/// @author    Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file tests the single-header amalgamation of Optrone used by the
+/// header-only build mode.
+///
+/// This project is licensed under the terms of MIT license.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "optrone/optrone_single.hpp"
+
+// Defined in `header_only_unit.cpp`, which includes the amalgamation too
+std::size_t parse_in_second_unit(const std::vector<std::string> &args);
+
+TEST_CASE("Header-only argument parsing")
+{
+    auto option = std::make_shared<optrone::option_template>(optrone::option_template{
+        .description = "Option.",
+        .short_names = { 'a' },
+        .long_names  = { "name" },
+        .params      = { "param" },
+        .defaults    = { "default" },
+    });
+
+    auto subcommand = std::make_shared<optrone::subcommand_template>(optrone::subcommand_template{
+        .description = "Subcommand.",
+        .names       = { "name" },
+    });
+
+    auto parsed_args = optrone::parse_arguments({ "--name=value", "name", "-a" }, { option }, { subcommand });
+
+    REQUIRE(parsed_args.size() == 3);
+    CHECK(parsed_args[0].ref_option.lock() == option);
+    CHECK(parsed_args[0].values == std::vector<std::string>{ "value" });
+    CHECK(parsed_args[1].ref_subcommand.lock() == subcommand);
+    CHECK(parsed_args[2].values == std::vector<std::string>{ "default" });
+
+    CHECK(optrone::format_saec("$rred$0", true) == "red");
+    CHECK_FALSE(optrone::get_help_message({ option }, { subcommand }).empty());
+}
+
+/// Dialect for the tests: POSIX-style, case-sensitive, with `-name` as a long
+/// name and no `=` splitting.
+struct strict_dialect : optrone::posix_dialect {
+    static constexpr bool case_sensitive  = true;
+    static constexpr bool bundling        = false;
+    static constexpr bool value_splitting = false;
+};
+
+TEST_CASE("Header-only custom dialect")
+{
+    auto option = std::make_shared<optrone::option_template>(optrone::option_template{
+        .description = "Option.",
+        .short_names = { 'a' },
+        .long_names  = { "name" },
+        .params      = { "param" },
+        .defaults    = { "default" },
+    });
+
+    auto parsed_args = optrone::parse_arguments<strict_dialect>({ "-name", "a=b", "/tmp", "-a" }, { option }, {}, { "path" });
+
+    REQUIRE(parsed_args.size() == 3);
+    CHECK(parsed_args[0].ref_option.lock() == option);
+    CHECK(parsed_args[0].values == std::vector<std::string>{ "a=b" });
+    CHECK(parsed_args[1].values == std::vector<std::string>{ "/tmp" });
+    CHECK(parsed_args[2].values == std::vector<std::string>{ "default" });
+
+    CHECK_THROWS_AS(optrone::parse_arguments<strict_dialect>({ "--NAME" }, { option }, {}), optrone::argument_error);
+    CHECK_THROWS_AS(optrone::parse_arguments<strict_dialect>({ "--name=value" }, { option }, {}), optrone::argument_error);
+}
+
+TEST_CASE("Header-only multiple translation units")
+{
+    CHECK(parse_in_second_unit({ "-a", "--name" }) == 2);
+    CHECK(optrone::parse_arguments({ "value" }, {}, {}, { "param" }).size() == 1);
+}
@@ -0,0 +1,32 @@
+/// @file
+///
+/// @author    Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file is a second translation unit including the single-header
+/// amalgamation, linked with `header_only.cpp` to check that the definitions
+/// do not collide across translation units.
+///
+/// This project is licensed under the terms of MIT license.
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "optrone/optrone_single.hpp"
+
+/// Parse the arguments against a single option, in this translation unit.
+/// @return Number of parsed arguments.
+std::size_t parse_in_second_unit(const std::vector<std::string> &args)
+{
+    auto option = std::make_shared<optrone::option_template>(optrone::option_template{
+        .description = "Option.",
+        .short_names = { 'a' },
+        .long_names  = { "name" },
+    });
+
+    std::string help = optrone::get_help_message({ option }, {});
+
+    return help.empty() ? 0 : optrone::parse_arguments<optrone::posix_dialect>(args, { option }, {}).size();
+}
@@ -0,0 +1,113 @@
+/// @file
+///
+/// @author    Anstro Pleuton <https://github.com/anstropleuton>
+/// @copyright Copyright (c) 2025 Anstro Pleuton
+///
+/// This test file tests that the taskmgr example answers the same through a
+/// server (`--serve`), which keeps the tasks and their indices loaded between
+/// commands, as when each command is run on its own.
+///
+/// This project is licensed under the terms of MIT license.
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "doctest/doctest.h"
+
+/// Run a shell command and return its output (including the errors).
+std::string run_command(const std::string &command)
+{
+    std::string output;
+    if (FILE *pipe = ::popen((command + " 2>&1").c_str(), "r"))
+    {
+        std::array<char, 4096> buffer;
+        while (std::size_t count = std::fread(buffer.data(), 1, buffer.size(), pipe))
+        {
+            output.append(buffer.data(), count);
+        }
+        ::pclose(pipe);
+    }
+    return output;
+}
+
+/// Run the commands with taskmgr both through a server and on their own, each
+/// in a directory of its own, and check that every command answers the same.
+void check_served_commands(const std::vector<std::string> &commands)
+{
+    std::filesystem::path root   = std::filesystem::temp_directory_path() / std::format("optrone_taskmgr_serve_{:x}", std::random_device {}());
+    std::filesystem::path served = root / "served";
+    std::filesystem::path direct = root / "direct";
+    std::filesystem::create_directories(served);
+    std::filesystem::create_directories(direct);
+
+    std::string socket = (root / "socket").string();
+    std::system(std::format("cd '{}' && '{}' --serve='{}' > /dev/null 2>&1 & echo $! > '{}'", served.string(), TASKMGR_EXECUTABLE, socket, (root / "pid").string()).c_str());
+
+    for (int attempt = 0; attempt < 500 && !std::filesystem::is_socket(socket); attempt++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(std::filesystem::is_socket(socket));
+
+    for (const std::string &command : commands)
+    {
+        CAPTURE(command);
+        std::string served_output = run_command(std::format("cd '{}' && TASKMGR_SOCKET='{}' '{}' {}", served.string(), socket, TASKMGR_EXECUTABLE, command));
+        std::string direct_output = run_command(std::format("cd '{}' && '{}' {}", direct.string(), TASKMGR_EXECUTABLE, command));
+        CHECK(served_output == direct_output);
+    }
+
+    std::system(std::format("kill $(cat '{}')", (root / "pid").string()).c_str());
+    for (int attempt = 0; attempt < 500 && std::filesystem::exists(socket); attempt++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("Served tag filter after writes")
+{
+    check_served_commands({
+        "add Zed",
+        "tags add 0 aa",
+        "list --filter aa",
+        "add Zed47",
+        "tags add 1 bb dd",
+        "list --filter bb",
+        "list --filter aa dd",
+        "tags remove 0 aa",
+        "list --filter aa",
+        "remove 0",
+        "list --filter bb",
+        "tags add 0 aa",
+        "list --filter aa",
+    });
+}
+
+TEST_CASE("Served priority sort after writes")
+{
+    check_served_commands({
+        "add a",
+        "list --sort priority",
+        "add b",
+        "add c",
+        "list --sort priority",
+        "edit priority 2 5",
+        "done 1",
+        "list --sort priority",
+        "list --sort completion",
+        "undo 1",
+        "remove 0",
+        "list --sort priority",
+    });
+}